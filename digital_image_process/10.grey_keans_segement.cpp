@@ -2,9 +2,37 @@
 #include <iostream>
 #include <vector>
 #include <opencv2/opencv.hpp>
+#include "histogram.h"
+#include "otsu.h"
+#include "point_transform.h"
 using namespace std;
 using namespace cv;
 
+//多阈值大津法分割：count个阈值把灰度分成count+1类，每个像素换成所在类的平均灰度(与K-means的中心值对应)
+//阈值和类均值都只用直方图计算，映射是一次查表
+Mat multi_otsu_segment(const Mat& src, int count) {
+    vector<int> hist = calc_histogram(src);
+    vector<int> thresholds = otsu_multi_threshold(hist, count);
+    if (thresholds.empty()) return Mat();
+    thresholds.push_back(255);
+
+    vector<double> class_mean(256, 0.0);
+    int begin = 0;
+    for (int t : thresholds) {
+        double n = 0, sum = 0;
+        for (int i = begin; i <= t; ++i) {
+            n += hist[i];
+            sum += (double)i * hist[i];
+        }
+        for (int i = begin; i <= t; ++i) class_mean[i] = n > 0 ? sum / n : 0.0;
+        cout << "类 [" << begin << ", " << t << "] 均值 " << (n > 0 ? sum / n : 0.0) << endl;
+        begin = t + 1;
+    }
+    Mat dst;
+    PointTransform([&](int r) { return class_mean[r]; }).apply(src, dst);
+    return dst;
+}
+
 int main() {
 
     // 使用 imread 加载图像，第二个参数 0 表示以灰度模式加载
@@ -45,6 +73,9 @@ int main() {
 
     imshow("Original Grayscale Image", src);
     imshow("K-means Segmented Image", dst);
+    // 与K-means相同的3类，用2个大津阈值分割
+    Mat otsu_dst = multi_otsu_segment(src, numCluster - 1);
+    imshow("Multi-level Otsu Segmented Image", otsu_dst);
 
     waitKey(0);
     destroyAllWindows();
@@ -0,0 +1,92 @@
+//全局阈值测速：逐像素迭代与直方图迭代、大津法的耗时对比 (指纹图像尺寸与8K图像)
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include "histogram.h"
+#include "global_threshold.h"
+
+using namespace std;
+using namespace cv;
+
+//原来的迭代法：每次迭代都扫描所有像素重新分组，作为对照
+static int iterative_threshold_by_pixels(const Mat& img_gray, int& iterations) {
+    double current_T = mean(img_gray)[0];
+    double previous_T = 0;
+    iterations = 0;
+    while (fabs(current_T - previous_T) > 1.0) {
+        previous_T = current_T;
+        iterations++;
+        long sum_g1 = 0, count_g1 = 0, sum_g2 = 0, count_g2 = 0;
+        for (int i = 0; i < img_gray.rows; ++i) {
+            const uchar* p = img_gray.ptr<uchar>(i);
+            for (int j = 0; j < img_gray.cols; ++j) {
+                if (p[j] > current_T) {
+                    sum_g1 += p[j];
+                    count_g1++;
+                } else {
+                    sum_g2 += p[j];
+                    count_g2++;
+                }
+            }
+        }
+        double mu1 = (count_g1 > 0) ? static_cast<double>(sum_g1) / count_g1 : 0;
+        double mu2 = (count_g2 > 0) ? static_cast<double>(sum_g2) / count_g2 : 0;
+        current_T = (mu1 + mu2) / 2.0;
+    }
+    return static_cast<int>(current_T);
+}
+
+static double elapsed_ms(int64 start, int iterations) {
+    return (getTickCount() - start) / getTickFrequency() * 1000.0 / iterations;
+}
+
+void run_threshold_benchmark(const string& name, const Mat& img, int iterations) {
+    cout << "--- " << name << " " << img.cols << "x" << img.rows << " ---" << endl;
+
+    int pixel_iterations = 0, pixel_T = 0;
+    int64 start = getTickCount();
+    for (int k = 0; k < iterations; ++k) pixel_T = iterative_threshold_by_pixels(img, pixel_iterations);
+    double pixel_ms = elapsed_ms(start, iterations);
+
+    vector<int> hist;
+    start = getTickCount();
+    for (int k = 0; k < iterations; ++k) calc_histogram(img, hist);
+    double hist_ms = elapsed_ms(start, iterations);
+
+    int hist_iterations = 0, hist_T = 0;
+    start = getTickCount();
+    for (int k = 0; k < iterations; ++k) hist_T = iterative_threshold(hist, 1.0, &hist_iterations);
+    double iterate_ms = elapsed_ms(start, iterations);
+
+    int otsu_T = 0;
+    start = getTickCount();
+    for (int k = 0; k < iterations; ++k) otsu_T = global_threshold(hist, GLOBAL_THRESHOLD_OTSU);
+    double otsu_ms = elapsed_ms(start, iterations);
+
+    cout << fixed << setprecision(3)
+         << " 逐像素迭代    " << setw(10) << pixel_ms << " ms  T = " << pixel_T << " (" << pixel_iterations << " 次迭代)" << endl
+         << " 直方图        " << setw(10) << hist_ms << " ms" << endl
+         << " 直方图迭代    " << setw(10) << iterate_ms << " ms  T = " << hist_T << " (" << hist_iterations << " 次迭代)"
+         << (hist_T == pixel_T ? "" : "  结果不同!") << endl
+         << " 直方图大津法  " << setw(10) << otsu_ms << " ms  T = " << otsu_T << endl
+         << " 加速比 x" << setprecision(1) << pixel_ms / (hist_ms + iterate_ms) << endl;
+    cout.unsetf(ios::floatfield);
+}
+
+int main() {
+    Mat fingerprint = imread("pic/fingerprint.tif", IMREAD_GRAYSCALE);
+    if (fingerprint.empty()) {
+        cerr << "错误: 无法加载图像 pic/fingerprint.tif" << endl;
+        return -1;
+    }
+    run_threshold_benchmark("fingerprint", fingerprint, 20);
+
+    //8K：把指纹图像放大，保留双峰的灰度分布
+    Mat frame;
+    resize(fingerprint, frame, Size(7680, 4320), 0, 0, INTER_LINEAR);
+    run_threshold_benchmark("8K", frame, 3);
+    return 0;
+}
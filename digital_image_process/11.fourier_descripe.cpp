@@ -1,67 +1,81 @@
 //傅里叶描述子:fourier_descripe
 //用目标边界曲线的傅里叶变换来描述目标区域的形状，将二维描述问题简化为一维描述问题
 
+#include <map>
+#include <complex>
 #include <opencv2/opencv.hpp>
+#include "fft_plan.h"
 using namespace cv;
 using namespace std;
- 
-void FourierShapeDescriptors(vector<Point>& contour, double ratio, vector<Point>& output_contour)
+
+//对多条轮廓计算傅里叶描述子并重构，ratios[i]为第i条轮廓保留的描述子比例
+//补零后长度相同的轮廓放在一起，用一次批量FFT完成正变换、一次完成反变换
+void FourierShapeDescriptorsBatch(const vector<vector<Point>>& contours, const vector<double>& ratios,
+                                  vector<vector<Point>>& output_contours)
 {
-    //将轮廓变为复数图像
-    Mat pointMat(contour.size(), 1, CV_32FC2);
-    Vec2f* p = pointMat.ptr<Vec2f>();
-    for (size_t i = 0; i < contour.size(); i++)
+    output_contours.assign(contours.size(), vector<Point>());
+    //按离散傅里叶变换的最优尺寸分组
+    map<int, vector<int>> groups;
+    for (size_t i = 0; i < contours.size(); i++)
     {
-        p[i][0] = (float)contour[i].x;
-        p[i][1] = (float)contour[i].y;
+        if (!contours[i].empty()) groups[getOptimalDFTSize((int)contours[i].size())].push_back((int)i);
     }
-    //计算离散傅里叶变换的最优尺寸
-    Mat paddedMat;
-    int m = getOptimalDFTSize(pointMat.rows);
-    int n = getOptimalDFTSize(pointMat.cols);
-    copyMakeBorder(pointMat, paddedMat, 0, m- pointMat.rows, 0, n - pointMat.cols, BORDER_CONSTANT, Scalar::all(0));
-    //中心化
-    p = paddedMat.ptr<Vec2f>();
-    for (size_t i = 0; i < m; i++)
+
+    for (const auto& group : groups)
     {
-        if (i % 2 != 0){
-            p[i][0] = - p[i][0];
-            p[i][1] = - p[i][1];
+        int m = group.first;
+        const vector<int>& ids = group.second;
+        int batch = (int)ids.size();
+        FFTPlan1Df plan(m);
+
+        //将轮廓变为复数序列，补零到m并中心化(奇数下标取反)
+        vector<complex<float>> data((size_t)m * batch, complex<float>(0, 0));
+        for (int b = 0; b < batch; b++)
+        {
+            const vector<Point>& contour = contours[ids[b]];
+            complex<float>* p = &data[(size_t)b * m];
+            for (size_t i = 0; i < contour.size(); i++)
+            {
+                float sign = (i % 2 != 0) ? -1.0f : 1.0f;
+                p[i] = complex<float>(sign * contour[i].x, sign * contour[i].y);
+            }
         }
-    }
-    //傅里叶变换
-    Mat dftMat;
-    dft(paddedMat, dftMat, DFT_COMPLEX_INPUT | DFT_COMPLEX_OUTPUT);
-     
-    //保留重构边界的描述子
-    int number = cvRound(m * ratio) & -2; // a & -2 代表最大不超过a的偶数
-    int number_remove = (m - number) / 2;
-    dftMat.rowRange(0, number_remove) = Scalar::all(0); //删除系数(设置为0)
-    dftMat.rowRange(dftMat.rows - number_remove, dftMat.rows) = Scalar::all(0);
-    //傅里叶反变换
-    Mat idftMat;
-    idft(dftMat, idftMat, DFT_COMPLEX_INPUT | DFT_COMPLEX_OUTPUT | DFT_SCALE);
-    //去中心化
-    p = idftMat.ptr<Vec2f>();
-    for (size_t i = 0; i < m; i++)
-    {
-        if (i % 2 != 0) {
-            p[i][0] = -p[i][0];
-            p[i][1] = -p[i][1];
+        //傅里叶变换
+        plan.execute_batch(data.data(), batch, false);
+
+        //保留重构边界的描述子
+        for (int b = 0; b < batch; b++)
+        {
+            complex<float>* p = &data[(size_t)b * m];
+            int number = cvRound(m * ratios[ids[b]]) & -2; // a & -2 代表最大不超过a的偶数
+            int number_remove = (m - number) / 2;
+            fill(p, p + number_remove, complex<float>(0, 0)); //删除系数(设置为0)
+            fill(p + m - number_remove, p + m, complex<float>(0, 0));
+        }
+        //傅里叶反变换 (结果已除以m)
+        plan.execute_batch(data.data(), batch, true);
+
+        //去中心化，裁剪为原来大小，变回轮廓点
+        for (int b = 0; b < batch; b++)
+        {
+            const complex<float>* p = &data[(size_t)b * m];
+            size_t count = contours[ids[b]].size();
+            vector<Point>& output = output_contours[ids[b]];
+            output.reserve(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                float sign = (i % 2 != 0) ? -1.0f : 1.0f;
+                output.push_back(Point(cvRound(sign * p[i].real()), cvRound(sign * p[i].imag())));
+            }
         }
     }
-    //裁剪为原来大小
-    Mat dst = idftMat.rowRange(0, contour.size()).clone();
-    dst.convertTo(dst, CV_32SC2);
- 
-    //由图像Mat变回轮廓点vector<Point>
-    Point point;
-    for (size_t i = 0; i < contour.size(); i++)
-    {
-        point.x = dst.ptr<cv::Vec2i>(i)[0][0];
-        point.y = dst.ptr<cv::Vec2i>(i)[0][1];
-        output_contour.push_back(point);
-    }
+}
+
+void FourierShapeDescriptors(vector<Point>& contour, double ratio, vector<Point>& output_contour)
+{
+    vector<vector<Point>> outputs;
+    FourierShapeDescriptorsBatch(vector<vector<Point>>(1, contour), vector<double>(1, ratio), outputs);
+    output_contour.insert(output_contour.end(), outputs[0].begin(), outputs[0].end());
 }
  
 int main() {
@@ -94,19 +108,19 @@ int main() {
     drawContours(result_display, original_contours, 0, Scalar(255, 0, 0), 1); // Blue
 
 
-    // 计算和绘制第一个逼近轮廓 (18个描述子)
-    vector<Point> output_contour_18;
+    // 两个逼近轮廓 (18个和8个描述子) 补零后长度相同，一次批量变换完成
     //ratio控制形状平滑程度或逼近精度
     double ratio_18 = 0.0063;
-    FourierShapeDescriptors(main_contour, ratio_18, output_contour_18);
-    vector<vector<Point>> contours_18 = { output_contour_18 };
+    double ratio_8 = 0.0028;
+    vector<vector<Point>> approximations;
+    FourierShapeDescriptorsBatch({ main_contour, main_contour }, { ratio_18, ratio_8 }, approximations);
+
+    // 绘制第一个逼近轮廓 (18个描述子)
+    vector<vector<Point>> contours_18 = { approximations[0] };
     drawContours(result_display, contours_18, 0, Scalar(0, 255, 0), 1); // Green
     
-    // 计算和绘制第二个逼近轮廓 (8个描述子)
-    vector<Point> output_contour_8;
-    double ratio_8 = 0.0028;
-    FourierShapeDescriptors(main_contour, ratio_8, output_contour_8);
-    vector<vector<Point>> contours_8 = { output_contour_8 };
+    // 绘制第二个逼近轮廓 (8个描述子)
+    vector<vector<Point>> contours_8 = { approximations[1] };
     drawContours(result_display, contours_8, 0, Scalar(0, 0, 255), 1); // Red
 
 
@@ -4,6 +4,9 @@
 #include <vector>
 #include <cmath> 
 #include <opencv2/opencv.hpp>
+#include "histogram.h"
+#include "point_transform.h"
+#include "clahe.h"
 using namespace std;
 using namespace cv;
 
@@ -16,48 +19,29 @@ Mat histogram_equal(const Mat& img_orig) {
         return Mat(); // 返回一个空Mat
     }
 
-    int rows = img_orig.rows;
-    int cols = img_orig.cols;
-    long total_pixels = rows * cols;
-    //计算直方图
-    vector<int> hist(256, 0); 
-    
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            //获取原始像素值
-            uchar pixel_value = img_orig.at<uchar>(i, j);
-            hist[pixel_value]++;
-        }
-    }
-
-    //计算累积分布函数 (CDF)
-    // cdf[i]将存储灰度值小于等于 i 的像素总数
-    vector<long> cdf(256, 0);
-    cdf[0] = hist[0];
-    for (int i = 1; i < 256; ++i) {
-        //当前的累积值 = 上一个累积值 + 当前灰度级的像素数
-        cdf[i] = cdf[i - 1] + hist[i];
-    }
+    long total_pixels = (long)img_orig.total();
+    //计算直方图 (多线程，见histogram.h)
+    vector<int> hist = calc_histogram(img_orig);
 
-    //创建查找表 (LUT) 并进行映射
-    //lut[i] 将存储原始灰度值 i 映射后的新灰度值
-    vector<uchar> lut(256);
-    double scale_factor = 255.0 / total_pixels; // (L-1) / (M*N)
-
-    for (int i = 0; i < 256; ++i) {
-        //s = round( (L-1)/(M*N) * cdf(r) )
-        lut[i] = static_cast<uchar>(round(scale_factor * cdf[i]));
-    }
-    
-    Mat result_img = Mat::zeros(img_orig.size(), img_orig.type());
+    //由累积分布函数 (CDF) 创建查找表 (LUT)：s = round( (L-1)/(M*N) * cdf(r) )
+    //与CLAHE每个块的查找表用同一个函数计算(见clahe.h)
+    uchar table[256];
+    equalization_lut(hist.data(), total_pixels, table);
+    PointTransform lut([&](int r) { return (double)table[r]; });
 
     // 使用查找表进行像素值映射
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            uchar original_value = img_orig.at<uchar>(i, j);
-            result_img.at<uchar>(i, j) = lut[original_value];
-        }
-    }
+    Mat result_img;
+    lut.apply(img_orig, result_img);
+    return result_img;
+}
+
+//限制对比度的自适应直方图均衡化(CLAHE)：每个块单独均衡化，直方图按clip_limit截断，
+//避免全局均衡化把高光拉爆，或者对局部低对比度区域不起作用
+Mat clahe_equal(const Mat& img_orig, double clip_limit = 4.0, Size tiles = Size(8, 8)) {
+    cout << "执行限制对比度的自适应直方图均衡化(CLAHE)" << endl;
+    Mat result_img;
+    Clahe clahe(clip_limit, tiles);
+    clahe.apply(img_orig, result_img);
     return result_img;
 }
 
@@ -94,9 +78,11 @@ int main() {
     }
 
     Mat he_result = histogram_equal(img_orig);
+    Mat clahe_result = clahe_equal(img_orig);
     
     imshow("Original Image", img_orig);
     imshow("Histogram Equal Result", he_result);
+    imshow("CLAHE Result", clahe_result);
     
     //显示直方图对比
     //准备直方图计算的参数
@@ -0,0 +1,133 @@
+//零填充卷积测速：直接计算、可分离两遍一维卷积与FFT快速卷积的交叉点，以及自动选择的结果；
+//8位定点卷积与double卷积的精度、耗时对比
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include "convolution.h"
+#include "fixed_point_convolution.h"
+
+using namespace std;
+using namespace cv;
+
+static double time_convolution(const Mat& src, const Mat& mask, Mat& dst, ConvMethod method, int iterations) {
+    int64 start = getTickCount();
+    for (int k = 0; k < iterations; ++k) {
+        convolve_zero_padding(src, dst, mask, method);
+    }
+    return (getTickCount() - start) / getTickFrequency() * 1000.0 / iterations;
+}
+
+//归一化的高斯模板，与GaussianMask相同的归一化方式
+static Mat gaussian_mask(int size, double sigma) {
+    Mat mask(size, size, CV_64F);
+    double center = (double)size / 2 - 0.5;
+    double sum = 0;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            double d2 = (i - center) * (i - center) + (j - center) * (j - center);
+            mask.at<double>(i, j) = exp(-d2 / (2 * sigma * sigma));
+            sum += mask.at<double>(i, j);
+        }
+    }
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) mask.at<double>(i, j) /= sum;
+    }
+    return mask;
+}
+
+//对一种图像尺寸扫描模板尺寸，打印两种方式的耗时、误差和自动选择的结果
+void run_crossover(const Mat& img, int max_mask) {
+    cout << "--- 图像 " << img.cols << "x" << img.rows << " ---" << endl;
+    cout << " 模板      直接(ms)     FFT(ms)  可分离(ms)   最大误差   自动选择" << endl;
+    int crossover = -1;
+    for (int size = 3; size <= max_mask; size += 2) {
+        Mat mask = gaussian_mask(size, size / 6.0);
+
+        Mat direct, fft, separable;
+        int iterations = size <= 9 ? 3 : 1;
+        double direct_ms = time_convolution(img, mask, direct, CONV_DIRECT, iterations);
+        double fft_ms = time_convolution(img, mask, fft, CONV_FFT, iterations);
+        double separable_ms = time_convolution(img, mask, separable, CONV_SEPARABLE, iterations);
+        double max_err = max(norm(direct, fft, NORM_INF), norm(direct, separable, NORM_INF));
+        ConvMethod chosen = choose_conv_method(img.cols, img.rows, size, size, true);
+        if (crossover < 0 && fft_ms < direct_ms) crossover = size;
+
+        cout << setw(3) << size << "x" << left << setw(3) << size << right
+             << fixed << setprecision(2)
+             << setw(12) << direct_ms << setw(12) << fft_ms << setw(12) << separable_ms
+             << scientific << setprecision(1) << setw(11) << max_err
+             << "   " << (chosen == CONV_FFT ? "FFT" : chosen == CONV_SEPARABLE ? "可分离" : "直接") << endl;
+        cout.unsetf(ios::floatfield);
+    }
+    if (crossover > 0) {
+        cout << "实测从 " << crossover << "x" << crossover << " 开始FFT比直接计算快" << endl;
+    }
+}
+
+//8位定点卷积与double路径(卷积后再转回8位)对比：最大误差、结果不同的像素比例、量化误差上界
+void run_fixed_point_report(const Mat& img) {
+    struct Case {
+        const char* name;
+        Mat mask;
+        bool absolute; //true时与convertScaleAbs比较，否则与saturate_cast比较
+    };
+    vector<Case> cases = {
+        {"均值3x3", Mat(3, 3, CV_64F, Scalar(1.0 / 9)), false},
+        {"均值7x7", Mat(7, 7, CV_64F, Scalar(1.0 / 49)), false},
+        {"高斯5x5", gaussian_mask(5, 1.0), false},
+        {"高斯9x9", gaussian_mask(9, 1.5), false},
+        {"拉普拉斯", (Mat_<double>(3, 3) << 0, -1, 0, -1, 5, -1, 0, -1, 0), true},
+        {"Sobel Gx", (Mat_<double>(3, 3) << -1, 0, 1, -2, 0, 2, -1, 0, 1), true},
+    };
+    cout << "--- 8位定点卷积 " << img.cols << "x" << img.rows << " ---" << endl;
+    cout << " 模板       shift 累加  double(ms)  定点(ms)  最大误差  不同像素  误差上界" << endl;
+    for (const Case& c : cases) {
+        FixedPointMask q = quantize_mask(c.mask);
+
+        int64 start = getTickCount();
+        Mat ref_64f, ref_8u;
+        convolve(img, ref_64f, c.mask, BORDER_MODE_ZERO, CONV_DIRECT);
+        if (c.absolute) {
+            convertScaleAbs(ref_64f, ref_8u);
+        } else {
+            ref_64f.convertTo(ref_8u, CV_8U);
+        }
+        double double_ms = (getTickCount() - start) / getTickFrequency() * 1000.0;
+
+        start = getTickCount();
+        Mat fixed_8u;
+        convolve_8u(img, fixed_8u, q, BORDER_MODE_ZERO, c.absolute);
+        double fixed_ms = (getTickCount() - start) / getTickFrequency() * 1000.0;
+
+        Mat diff;
+        absdiff(ref_8u, fixed_8u, diff);
+        double max_err = norm(ref_8u, fixed_8u, NORM_INF);
+        double changed = 100.0 * countNonZero(diff) / (double)img.total();
+
+        cout << " " << left << setw(10) << c.name << right << setw(6) << q.shift
+             << setw(6) << (q.accumulate_16bit ? "16" : "32")
+             << fixed << setprecision(2) << setw(12) << double_ms << setw(10) << fixed_ms
+             << setprecision(0) << setw(10) << max_err
+             << setprecision(3) << setw(9) << changed << "%"
+             << scientific << setprecision(1) << setw(10) << q.max_output_error << endl;
+        cout.unsetf(ios::floatfield);
+    }
+}
+
+int main() {
+    Mat img = imread("pic/fft.tif", IMREAD_GRAYSCALE);
+    if (img.empty()) {
+        cerr << "错误: 无法加载图像 pic/fft.tif" << endl;
+        return -1;
+    }
+    run_crossover(img, 31);
+    run_fixed_point_report(img);
+
+    Mat frame(1080, 1920, CV_8UC1);
+    randu(frame, Scalar::all(0), Scalar::all(256));
+    run_crossover(frame, 25);
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <vector>
 #include <algorithm> 
 #include <opencv2/opencv.hpp>
+#include "point_transform.h"
 using namespace std;
 using namespace cv;
 
@@ -28,22 +29,9 @@ Mat contrast_stretching(const Mat& img_orig) {
     if (A == 0 && B == 255) {
         return img_orig.clone();
     }
-    //创建一个与原图同样大小和类型的新Mat来存储结果
-    Mat result_img = Mat::zeros(img_orig.size(), img_orig.type());
-
-    int rows = img_orig.rows;
-    int cols = img_orig.cols;
-
-    //遍历每一个像素并应用线性拉伸公式
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            uchar r = img_orig.at<uchar>(i, j);
-            //s = 255.0 / (B - A) * (r - A)
-            //+0.5进行四舍五入
-            uchar s = static_cast<uchar>(255.0 / (B - A) * (r - A) + 0.5);
-            result_img.at<uchar>(i, j) = s;
-        }
-    }
+    //s = 255.0 / (B - A) * (r - A)，+0.5进行四舍五入；预先算成256项的查找表
+    Mat result_img;
+    PointTransform::contrast_stretch(A, B).apply(img_orig, result_img);
     return result_img;
 }
 
@@ -58,28 +46,9 @@ Mat gray_level_slicing(const Mat& img_orig, int lower_bound, int upper_bound, in
         return Mat();
     }
 
-    Mat result_img = Mat::zeros(img_orig.size(), img_orig.type());
-    int rows = img_orig.rows;
-    int cols = img_orig.cols;
-
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            uchar r = img_orig.at<uchar>(i, j);
-            
-            // 检查像素值是否在感兴趣的区间内
-            if (r >= lower_bound && r <= upper_bound) {
-                result_img.at<uchar>(i, j) = static_cast<uchar>(highlight_val);
-            } else {
-                if (keep_background) {
-                    // 保留背景
-                    result_img.at<uchar>(i, j) = r;
-                } else {
-                    // 将背景设为0 (或任何其他指定值)
-                    result_img.at<uchar>(i, j) = 0;
-                }
-            }
-        }
-    }
+    //区间内的像素设为highlight_val，背景保留原值或置0；每个灰度的结果预先算成查找表，不需要逐像素分支
+    Mat result_img;
+    PointTransform::slice(lower_bound, upper_bound, highlight_val, keep_background).apply(img_orig, result_img);
     return result_img;
 }
 
@@ -97,28 +66,10 @@ Mat bit_slicing(const Mat& img_orig, int bit_plane) {
         return Mat();
     }
 
-    Mat result_img = Mat::zeros(img_orig.size(), img_orig.type());
-    int rows = img_orig.rows;
-    int cols = img_orig.cols;
-    
-    // 创建一个掩码 (mask) 来提取特定的位
-    // 比如要提取第3位 (bit_plane=3), 掩码是 2^(3-1) = 4, 二进制是 00000100
-    uchar mask = 1 << (bit_plane - 1); 
-
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            uchar r = img_orig.at<uchar>(i, j);
-            
-            // 使用位与(&)运算检查该位是否为1
-            if ((r & mask) != 0) {
-                // 如果该位为1，则输出像素设为255 (高亮)
-                result_img.at<uchar>(i, j) = 255;
-            } else {
-                // 如果该位为0，则输出像素设为0
-                result_img.at<uchar>(i, j) = 0;
-            }
-        }
-    }
+    // 用掩码 2^(bit_plane-1) 检查该位是否为1 (比如第3位的掩码是4，二进制00000100)
+    // 该位为1的灰度输出255 (高亮)，否则输出0；256种灰度的结果预先算成查找表
+    Mat result_img;
+    PointTransform::bit_plane(bit_plane).apply(img_orig, result_img);
     return result_img;
 }
 
@@ -5,37 +5,12 @@
 #include <vector>
 #include <cmath>
 #include <opencv2/opencv.hpp>
+#include "fixed_point_convolution.h"
+#include "spatial_executor.h"
+#include "gradient.h"
 
 using namespace std;
 using namespace cv;
-//卷积计算
-void RealCOV_ZeroPadding(const Mat& src, Mat& dst, const Mat& mask) {
-    int width = src.cols;
-    int height = src.rows;
-    int m_width = mask.cols;
-    int m_height = mask.rows;
-    int mask_center_h = m_height / 2;
-    int mask_center_w = m_width / 2;
-
-    dst = Mat::zeros(src.size(), CV_64F); // 目标Mat使用double保证精度
-
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            double value = 0.0;
-            for (int n = 0; n < m_height; n++) {
-                for (int m = 0; m < m_width; m++) {
-                    int src_i = i + n - mask_center_h;
-                    int src_j = j + m - mask_center_w;
-
-                    if (src_i >= 0 && src_i < height && src_j >= 0 && src_j < width) {
-                        value += (double)src.at<uchar>(src_i, src_j) * mask.at<double>(n, m);
-                    }
-                }
-            }
-            dst.at<double>(i, j) = value;
-        }
-    }
-}
 
 //拉普拉斯锐化
 Mat laplacian_sharpen(const Mat& img_orig) {
@@ -51,13 +26,10 @@ Mat laplacian_sharpen(const Mat& img_orig) {
                 -1,  5, -1,
                  0, -1,  0);
     
-    Mat cov_result;
-    RealCOV_ZeroPadding(img_orig, cov_result, mask);
-
-    // 将结果安全地转换回8位图像
-    // convertScaleAbs会取绝对值并缩放到0-255
+    // 模板是整数，直接在8位图像上做定点卷积(16位累加)，结果取绝对值并饱和到0-255
+    // 与零填充的double卷积再convertScaleAbs的结果完全相同，不需要中间的CV_64F图像；图像分块多线程计算
     Mat result_img;
-    convertScaleAbs(cov_result, result_img);
+    run_tiled(FixedPointSpatialFilter(quantize_mask(mask), true), img_orig, result_img, BORDER_MODE_ZERO);
 
     return result_img;
 }
@@ -69,34 +41,15 @@ Mat sobel_edge(const Mat& img_orig) {
         cerr << "错误: Sobel函数只支持8位单通道灰度图" << endl;
         return Mat();
     }
-    //定义Sobel的Gx和Gy模板
-    Mat mask_gx = (Mat_<double>(3, 3) << 
-                   -1, 0, 1,
-                   -2, 0, 2,
-                   -1, 0, 1);
-
-    Mat mask_gy = (Mat_<double>(3, 3) << 
-                   -1, -2, -1,
-                    0,  0,  0,
-                    1,  2,  1);
-
-    //分别计算x和y方向的梯度
-    Mat gx_result, gy_result;
-    RealCOV_ZeroPadding(img_orig, gx_result, mask_gx);
-    RealCOV_ZeroPadding(img_orig, gy_result, mask_gy);
-
-    //将Gx和Gy的结果转换为可显示的8位图
-    Mat abs_gx, abs_gy;
-    convertScaleAbs(gx_result, abs_gx);
-    convertScaleAbs(gy_result, abs_gy);
-    
-    //显示x和y方向的梯度
-    // imshow("Sobel X Gradient", abs_gx);
-    // imshow("Sobel Y Gradient", abs_gy);
-
-    // 组合梯度 G = |Gx| + |Gy|
-    Mat result_img;
-    addWeighted(abs_gx, 0.5, abs_gy, 0.5, 0, result_img);
+    //Gx、Gy模板分别为
+    //  -1 0 1      -1 -2 -1
+    //  -2 0 2       0  0  0
+    //  -1 0 1       1  2  1
+    //一次扫描算出两个方向的梯度并组合 G = (|Gx| + |Gy|) / 2，每个3x3邻域只读一次，不产生中间图像
+    //需要Gx、Gy本身(显示x和y方向的梯度)时在outputs中加上GRADIENT_GX | GRADIENT_GY
+    SobelGradient gradient;
+    sobel_gradient(img_orig, gradient, GRADIENT_EDGE_8U, GRADIENT_NORM_L1, 4, BORDER_MODE_ZERO);
+    Mat result_img = gradient.edge;
     return result_img;
 }
 
@@ -6,6 +6,10 @@
 #include <algorithm>
 #include<vector>
 #include<opencv2/opencv.hpp>
+#include "convolution.h"
+#include "median_filter.h"
+#include "fixed_point_convolution.h"
+#include "spatial_executor.h"
 #define GRAY_LEVEL 8//灰度级
 #define WIDTH 10
 #define HEIGHT 10//图像尺寸
@@ -14,33 +18,12 @@
 #define M_PI 3.14159265358979323846
 using namespace std;
 
-//二维卷积运算（边界零填充法）
-void RealCOV(double *src, double *dst, double *mask,  int width, int height, int m_width, int m_height){
+//二维卷积运算（默认边界零填充法，border可选复制、镜像、周期延拓）
+//模板较大时convolve自动改用FFT快速卷积，结果只差舍入误差
+void RealCOV(double *src, double *dst, double *mask,  int width, int height, int m_width, int m_height,
+             BorderMode border = BORDER_MODE_ZERO){
     //src dst指向源图像和目标图像的像素数据，msk指向滤波器模板的数据
-    //计算滤波器模板对的中心点坐标
-    int mask_center_h = m_height / 2 ;//横坐标
-    int mask_center_w = m_width / 2 ;//纵坐标
-    //遍历图像中的每一个像素
-    for(int i = 0 ; i < height ; i++ ){
-        for(int j = 0 ; j < width ; j++ ){//
-            double value = 0.0 ;
-            //遍历滤波器模板
-            for(int n = 0 ; n < m_height ; n++ ){
-                for(int m = 0 ; m < m_width ; m++ ){
-                    //计算当前模板元素对应的源图像像素坐标
-                    int src_i=i + (n-mask_center_h);
-                    int src_j=j + (m-mask_center_w);
-
-                    //零填充
-                    if(src_i>= 0 && src_i < height && src_j>= 0 &&src_j < width){
-                        value += src[src_i*width + src_j] * mask[n*m_width+m] ;  
-                    }
-                }
-            }
-            //存储输出图像的一维数组
-            dst[i*width+j] = value ;
-        }
-    }
+    convolve(src, dst, mask, width, height, m_width, m_height, border) ;
 }
 
 //均值滤波器模板生成
@@ -53,11 +36,11 @@ void MeanMask(double *mask,int width,int height){
     }
 }
 //调用卷积函数实现滤波
+//均值模板所有元素相等，用滑动窗口求和(盒子滤波)，每个像素的计算量与模板尺寸无关
+//与其他空间滤波一样分块多线程计算(见spatial_executor.h)，边界零填充
 void MeanFilter(double *src, double *dst, int width,int height,int m_width,int m_height){
-    double *mask = new double[m_width * m_height] ;
-    MeanMask(mask, m_width, m_height) ;
-    RealCOV(src, dst, mask,  width, height, m_width, m_height) ; 
-    delete[] mask;
+    cv::Mat src_img(height, width, CV_64FC1, src), dst_img(height, width, CV_64FC1, dst) ;
+    run_tiled(BoxSpatialFilter(m_width, m_height, 1.0 / (m_width * m_height)), src_img, dst_img, BORDER_MODE_ZERO) ;
 }
 
 
@@ -87,98 +70,63 @@ void GaussianMask(double *mask,int width,int height,double deta){
     }
 }
 
+//一维高斯模板，归一化后两个一维模板的外积就是GaussianMask生成的二维模板
+void GaussianMask1D(double *kernel, int size, double deta){
+    double center = (double)size / 2 - 0.5 ;
+    double sum = 0.0 ;
+    for(int i = 0 ; i < size ; i++){
+        kernel[i] = exp(-pow(i - center, 2) / (2 * deta * deta)) ;
+        sum += kernel[i] ;
+    }
+    for(int i = 0 ; i < size ; i++){
+        kernel[i] /= sum ;
+    }
+}
+
 void GaussianFilter(double *src, double *dst, int width, int height,int m_width,int m_height, double deta){
-    double *mask = new double[width * height] ;
-    GaussianMask(mask, m_width, m_height, deta) ;
-    RealCOV(src, dst, mask,  width, height, m_width, m_height) ; 
-    delete[] mask;
+    vector<double> kernel_x(m_width), kernel_y(m_height) ;
+    GaussianMask1D(kernel_x.data(), m_width, deta) ;
+    GaussianMask1D(kernel_y.data(), m_height, deta) ;
+    cv::Mat src_img(height, width, CV_64FC1, src), dst_img(height, width, CV_64FC1, dst) ;
+    run_tiled(SeparableSpatialFilter(kernel_x, kernel_y), src_img, dst_img, BORDER_MODE_ZERO) ;
+}
+
+
+//8位图像直接做定点卷积：模板量化为int16，32位累加，结果舍入后饱和到0-255，不需要double缓冲区
+//与double版本再取整的结果最多相差1个灰度级(见3.convolution_benchmark.cpp的精度对比)
+//图像按L2缓存大小分块，多线程计算(见spatial_executor.h)
+void MeanFilter(const uchar *src, uchar *dst, int width, int height, int m_width, int m_height){
+    vector<double> mask(m_width * m_height) ;
+    MeanMask(mask.data(), m_width, m_height) ;
+    cv::Mat src_img(height, width, CV_8UC1, const_cast<uchar*>(src)), dst_img(height, width, CV_8UC1, dst) ;
+    run_tiled(FixedPointSpatialFilter(quantize_mask(mask.data(), m_width, m_height)), src_img, dst_img, BORDER_MODE_ZERO) ;
 }
 
+void GaussianFilter(const uchar *src, uchar *dst, int width, int height, int m_width, int m_height, double deta){
+    vector<double> mask(m_width * m_height) ;
+    GaussianMask(mask.data(), m_width, m_height, deta) ;
+    cv::Mat src_img(height, width, CV_8UC1, const_cast<uchar*>(src)), dst_img(height, width, CV_8UC1, dst) ;
+    run_tiled(FixedPointSpatialFilter(quantize_mask(mask.data(), m_width, m_height)), src_img, dst_img, BORDER_MODE_ZERO) ;
+}
 
 //中值滤波器
 //用一个像素邻域内所有像素值的中值来代替该像素原来的值）
+//三种边界处理都由border参数选择：8位数据用O(1)的列直方图，3x3、5x5用排序网络，图像分块多线程计算
+static void TiledMedian(double *src, double *dst, int width, int height, int m_width, int m_height, BorderMode border){
+    cv::Mat src_img(height, width, CV_64FC1, src), dst_img(height, width, CV_64FC1, dst) ;
+    run_tiled(MedianSpatialFilter(m_width, m_height), src_img, dst_img, border) ;
+}
+//边界忽略法：模板超出图像的像素输出0
 void MedianFilter(double *src, double *dst, int width, int height, int m_width, int m_height){
-    //这里没有mask，只是模拟一个m_width和m_height的矩阵区域
-    int mask_size = m_width * m_height;
-    int mask_center_h = m_height / 2 ;
-    int mask_center_w = m_width / 2 ;
-
-    for(int i = 0 ; i < height ; i++ ){
-        for(int j = 0 ; j < width ; j++ ){
-            double value = 0.0 ;
-            //边界忽略法
-            if((i-mask_center_h)>=0 && (j-mask_center_w)>=0 &&(i+mask_center_h)<height && (j+mask_center_w)<width ){
-                vector<double> sort_arr;
-                sort_arr.reserve(mask_size);
-            	for(int n = 0 ; n < m_height ; n++ ){
-	                for(int m = 0 ; m < m_width ; m++ ){
-						sort_arr.push_back(src[(i+n-mask_center_h)*width + (j+m-mask_center_w)] );
-	                }
-            	}
-                //排序
-                sort(sort_arr.begin(), sort_arr.end());
-                value = sort_arr[mask_size/2] ;
-			}
-            dst[i*width+j] = value ;
-            //零填充法
-            //边界复制法
-        }
-    }
+    TiledMedian(src, dst, width, height, m_width, m_height, BORDER_MODE_IGNORE);
 }
 //零填充法
 void MedianFilter_Zero(double *src, double *dst, int width, int height, int m_width, int m_height) {
-    const int mask_size = m_width * m_height;
-    const int mask_center_h = m_height / 2;
-    const int mask_center_w = m_width / 2;
-
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            
-            vector<double> sort_arr;
-            sort_arr.reserve(mask_size);
-            for (int n = 0; n < m_height; n++) {
-                for (int m = 0; m < m_width; m++) {
-                    int src_i = i + n - mask_center_h;
-                    int src_j = j + m - mask_center_w;
-
-                    if (src_i >= 0 && src_i < height && src_j >= 0 && src_j < width) {
-                        sort_arr.push_back(src[src_i * width + src_j]);
-                    } else {
-                        sort_arr.push_back(0.0);
-                    }
-                }
-            }
-            sort(sort_arr.begin(), sort_arr.end());
-            dst[i * width + j] = sort_arr[mask_size/2];
-        }
-    }
+    TiledMedian(src, dst, width, height, m_width, m_height, BORDER_MODE_ZERO);
 }
 //边界复制法
 void MedianFilter_ReplicateBorder(double *src, double *dst, int width, int height, int m_width, int m_height) {
-    const int mask_size = m_width * m_height;
-    const int mask_center_h = m_height / 2;
-    const int mask_center_w = m_width / 2;
-
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            
-            vector<double> sort_arr;
-            sort_arr.reserve(mask_size);
-            for (int n = 0; n < m_height; n++) {
-                for (int m = 0; m < m_width; m++) {
-                    int src_i = i + n - mask_center_h;
-                    int src_j = j + m - mask_center_w;
-
-                    //将可能越界的坐标“夹”回有效范围内
-                    int clamped_i = max(0, min(src_i, height - 1));
-                    int clamped_j = max(0, min(src_j, width - 1));
-                    sort_arr.push_back(src[clamped_i * width + clamped_j]);
-                }
-            }
-            sort(sort_arr.begin(), sort_arr.end());
-            dst[i * width + j] = sort_arr[mask_size/2];
-        }
-    }
+    TiledMedian(src, dst, width, height, m_width, m_height, BORDER_MODE_REPLICATE);
 }
 
 int main(){
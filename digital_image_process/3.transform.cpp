@@ -10,6 +10,7 @@
 #include <vector>
 #include <cmath>
 #include <opencv2/opencv.hpp>
+#include "point_transform.h"
 
 using namespace std;
 using namespace cv;
@@ -22,23 +23,9 @@ Mat inverse_transform(const Mat& img_orig) {
         cerr << "错误: 图像反转函数仅支持8位单通道灰度图" << endl;
         return Mat(); // 返回一个空Mat
     }
-    //创建一个与原图同样大小和类型的新Mat来存储结果
-    Mat result_img = Mat::zeros(img_orig.size(), img_orig.type());
-
-    int rows = img_orig.rows;
-    int cols = img_orig.cols;
-
-    //遍历每一个像素
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            //获取原始像素值 r
-            //uchar 在OpenCV中被广泛用来表示8位图像的像素值
-            uchar r = img_orig.at<uchar>(i, j);
-            // 应用变换公式 s = 255 - r
-            result_img.at<uchar>(i, j) = 255 - r;
-            //访问并返回位于 (i, j) 位置的、类型为 uchar 的像素值
-        }
-    }
+    //8位图像的逐点变换只有256种输入，查表 s = 255 - r
+    Mat result_img;
+    PointTransform::inverse().apply(img_orig, result_img);
     return result_img;
 }
 //对输入的8位灰度图进行对数变换
@@ -48,26 +35,12 @@ Mat log_transform(const Mat& img_orig, double c) {
         cerr << "错误: 对数变换函数只支持8位单通道灰度图" << endl;
         return Mat();
     }
-    Mat temp_img = Mat::zeros(img_orig.size(), CV_64F);
-
-    int rows = img_orig.rows;
-    int cols = img_orig.cols;
-
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            double r = (double)img_orig.at<uchar>(i, j);
-            //s = c * log(1 + r)
-            temp_img.at<double>(i, j) = c * log(1.0 + r);
-        }
-    }
-    
-    //归一化到0-255范围,最小-最大值归一化法。
-    normalize(temp_img, temp_img, 0, 255, NORM_MINMAX);
-    
-    //将归一化后的浮点数Mat转换为8位无符号整型Mat
+    //s = c * log(1 + r)，再按图像中s的最小、最大值归一化到0-255范围(最小-最大值归一化法)
+    //只有256种灰度，归一化也只取决于图像的灰度范围，整个变换预先算成查找表，不需要CV_64F的中间图像
+    double min_val, max_val;
+    minMaxLoc(img_orig, &min_val, &max_val);
     Mat result_img;
-    //将Mat数据类型转换为另一种指定的类型
-    temp_img.convertTo(result_img, CV_8U);
+    PointTransform::log(c, (int)min_val, (int)max_val).apply(img_orig, result_img);
     
     return result_img;
 }
@@ -79,21 +52,11 @@ Mat gamma_transform(const Mat& img_orig, double c, double gamma) {
         cerr << "错误: 伽马变换函数只支持8位单通道灰度图" << endl;
         return Mat();
     }
-    Mat temp_img = Mat::zeros(img_orig.size(), CV_64F);
-    
-    int rows = img_orig.rows;
-    int cols = img_orig.cols;
-
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            double r = (double)img_orig.at<uchar>(i, j);
-            //s = c * r^gamma
-            temp_img.at<double>(i, j) = c* pow(r, gamma);
-        }
-    }
-    normalize(temp_img, temp_img, 0, 255, NORM_MINMAX);
+    //s = c * r^gamma，与对数变换一样归一化后查表
+    double min_val, max_val;
+    minMaxLoc(img_orig, &min_val, &max_val);
     Mat result_img;
-    temp_img.convertTo(result_img, CV_8U);
+    PointTransform::gamma(c, gamma, (int)min_val, (int)max_val).apply(img_orig, result_img);
     
     return result_img;
 }
@@ -0,0 +1,187 @@
+//FFT计划测速：标量、SSE2、AVX2蝶形核函数，双精度与单精度对比，批量小尺寸变换，以及行列变换的多线程扩展
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include "fft_plan.h"
+
+using namespace std;
+using namespace cv;
+
+static const char* simd_level_name(FFTSimdLevel level) {
+    switch (level) {
+    case FFT_SIMD_SSE2: return "SSE2";
+    case FFT_SIMD_AVX2: return "AVX2";
+    default: return "scalar";
+    }
+}
+
+//一次完整的滤波流程所需的变换：载入、R2C正变换、C2R逆变换，返回平均耗时(毫秒)
+template<typename T>
+double time_real_fft(RealFFTPlan2D_<T>& plan, const Mat& img, int iterations) {
+    plan.load(img);
+    plan.forward();
+    plan.inverse(); //预热：分配线程局部工作缓冲区
+
+    int64 start = getTickCount();
+    for (int k = 0; k < iterations; ++k) {
+        plan.load(img);
+        plan.forward();
+        plan.inverse();
+    }
+    double seconds = (getTickCount() - start) / getTickFrequency();
+    return seconds * 1000.0 / iterations;
+}
+
+//同一幅图像正、逆变换后，单精度结果与双精度结果的最大绝对误差(像素灰度单位)
+double float_vs_double_error(const Mat& img, int rows, int cols) {
+    RealFFTPlan2D plan_d(rows, cols);
+    RealFFTPlan2Df plan_f(rows, cols);
+    plan_d.load(img);
+    plan_f.load(img);
+    plan_d.forward();
+    plan_f.forward();
+    plan_d.inverse();
+    plan_f.inverse();
+
+    double max_err = 0;
+    for (int i = 0; i < rows; ++i) {
+        const double* pd = plan_d.real_row(i);
+        const float* pf = plan_f.real_row(i);
+        for (int j = 0; j < cols; ++j) {
+            max_err = max(max_err, fabs(pd[j] - (double)pf[j]));
+        }
+    }
+    return max_err;
+}
+
+void run_benchmark(const string& name, const Mat& img, int iterations) {
+    int rows = getOptimalDFTSize(img.rows);
+    int cols = getOptimalDFTSize(img.cols);
+    cout << "--- " << name << ": " << img.cols << "x" << img.rows
+         << " (补零到 " << cols << "x" << rows << "), " << iterations << " 次平均 ---" << endl;
+
+    RealFFTPlan2D plan_d(rows, cols);
+    RealFFTPlan2Df plan_f(rows, cols);
+
+    //基准：标量双精度的Stockham路径 (不是原来的fft_1d)，下面的加速比都相对于它
+    fft_set_simd_level(FFT_SIMD_SCALAR);
+    double base_ms = time_real_fft(plan_d, img, iterations);
+
+    for (int level = FFT_SIMD_SCALAR; level <= FFT_SIMD_AVX2; ++level) {
+        fft_set_simd_level((FFTSimdLevel)level);
+        if (fft_simd_level() != level) {
+            cout << setw(8) << simd_level_name((FFTSimdLevel)level) << ": CPU不支持，跳过" << endl;
+            continue;
+        }
+        double ms_d = (level == FFT_SIMD_SCALAR) ? base_ms : time_real_fft(plan_d, img, iterations);
+        double ms_f = time_real_fft(plan_f, img, iterations);
+        cout << fixed << setprecision(2)
+             << setw(8) << simd_level_name((FFTSimdLevel)level)
+             << "  double " << setw(9) << ms_d << " ms (x" << base_ms / ms_d << ")"
+             << "  float " << setw(9) << ms_f << " ms (x" << base_ms / ms_f << ")" << endl;
+    }
+    fft_set_simd_level(FFT_SIMD_AVX2);
+
+    cout << "单精度与双精度结果最大误差: " << scientific << setprecision(3)
+         << float_vs_double_error(img, rows, cols) << " (灰度值)" << endl;
+    cout.unsetf(ios::floatfield);
+}
+
+//多线程扩展曲线：线程数为1、2、4、8、16时的耗时和相对单线程的加速比
+void run_thread_scaling(const string& name, const Mat& img, int iterations) {
+    int rows = getOptimalDFTSize(img.rows);
+    int cols = getOptimalDFTSize(img.cols);
+    cout << "--- " << name << ": 多线程扩展 (" << simd_level_name(fft_simd_level())
+         << ", CPU核数 " << getNumberOfCPUs() << ") ---" << endl;
+
+    RealFFTPlan2D plan_d(rows, cols);
+    RealFFTPlan2Df plan_f(rows, cols);
+    int saved_threads = getNumThreads();
+    double base_d = 0, base_f = 0;
+    const int thread_counts[] = { 1, 2, 4, 8, 16 };
+    for (int threads : thread_counts) {
+        //OpenCV线程池至少要有threads个线程，fft_set_num_threads再把每次变换分成threads段
+        setNumThreads(threads);
+        fft_set_num_threads(threads);
+        double ms_d = time_real_fft(plan_d, img, iterations);
+        double ms_f = time_real_fft(plan_f, img, iterations);
+        if (threads == 1) {
+            base_d = ms_d;
+            base_f = ms_f;
+        }
+        cout << fixed << setprecision(2)
+             << setw(4) << threads << " 线程"
+             << "  double " << setw(9) << ms_d << " ms (x" << base_d / ms_d << ")"
+             << "  float " << setw(9) << ms_f << " ms (x" << base_f / ms_f << ")" << endl;
+    }
+    cout.unsetf(ios::floatfield);
+    setNumThreads(saved_threads);
+    fft_set_num_threads(0);
+}
+
+//批量一维FFT吞吐量：batch个长度为n的信号，逐个execute与一次execute_batch对比 (单线程)
+template<typename T>
+void run_batch_benchmark(int batch, int iterations) {
+    cout << "--- 批量1D FFT: " << batch << " 个信号, " << (sizeof(T) == 4 ? "float" : "double")
+         << ", " << simd_level_name(fft_simd_level()) << " ---" << endl;
+    const int lengths[] = { 64, 128, 256, 512, 1024 };
+    for (int n : lengths) {
+        FFTPlan1D_<T> plan(n);
+        vector<complex<T>> data((size_t)n * batch);
+        for (size_t i = 0; i < data.size(); ++i) data[i] = complex<T>((T)(i % 17), (T)(i % 5));
+
+        plan.execute_batch(data.data(), batch, false); //预热
+        int64 start = getTickCount();
+        for (int k = 0; k < iterations; ++k) {
+            for (int b = 0; b < batch; ++b) plan.execute(data.data() + (size_t)b * n, k % 2 == 1);
+        }
+        double single_s = (getTickCount() - start) / getTickFrequency();
+
+        start = getTickCount();
+        for (int k = 0; k < iterations; ++k) plan.execute_batch(data.data(), batch, k % 2 == 1);
+        double batch_s = (getTickCount() - start) / getTickFrequency();
+
+        double total = (double)batch * iterations;
+        cout << fixed << setprecision(2)
+             << "  n = " << setw(4) << n
+             << "  逐个 " << setw(8) << total / single_s / 1e6 << " M次/秒"
+             << "  批量 " << setw(8) << total / batch_s / 1e6 << " M次/秒"
+             << "  (x" << single_s / batch_s << ")" << endl;
+    }
+    cout.unsetf(ios::floatfield);
+}
+
+int main() {
+    cout << "CPU支持的最高指令集: " << simd_level_name(fft_simd_level()) << endl;
+
+    //指令集对比只测单线程
+    fft_set_num_threads(1);
+
+    //1. 滤波示例使用的图像
+    string image_path = "pic/fft.tif";
+    Mat img = imread(image_path, IMREAD_GRAYSCALE);
+    if (img.empty()) {
+        cerr << "错误: 无法加载图像 " << image_path << endl;
+        return -1;
+    }
+    run_benchmark("fft.tif", img, 20);
+
+    //2. 合成的4K帧 (3840x2160)
+    Mat frame(2160, 3840, CV_8UC1);
+    randu(frame, Scalar::all(0), Scalar::all(256));
+    run_benchmark("synthetic 4K", frame, 5);
+
+    //3. 轮廓、纹理窗口等大量小尺寸变换
+    run_batch_benchmark<float>(4096, 10);
+    run_batch_benchmark<double>(4096, 10);
+
+    run_thread_scaling("fft.tif", img, 20);
+    run_thread_scaling("synthetic 4K", frame, 5);
+
+    return 0;
+}
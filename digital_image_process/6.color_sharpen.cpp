@@ -5,6 +5,7 @@
 #include <iostream>
 #include <vector>
 #include <opencv2/opencv.hpp>
+#include "color_filter.h"
 
 using namespace std;
 using namespace cv;
@@ -17,27 +18,11 @@ Mat sharpen_in_rgb_space(const Mat& src_img) {
         return Mat();
     }
 
-    vector<Mat> bgr_channels;
-    split(src_img, bgr_channels);
-
-    // 对每个通道独立地进行拉普拉斯滤波
-    for (int i = 0; i < 3; ++i) {
-        Mat laplacian_result;
-        // 拉普拉斯结果可能有负值，需要用更高位深度的类型(CV_16S)来存储
-        Laplacian(bgr_channels[i], laplacian_result, CV_16S);
-        
-        // 将结果安全地转换回CV_8U，以便进行减法运算
-        Mat laplacian_8u;
-        convertScaleAbs(laplacian_result, laplacian_8u);
-
-        // 将拉普拉斯结果从原始通道中减去，以实现锐化
-        // 锐化图像 = 原始图像 - 拉普拉斯结果
-        subtract(bgr_channels[i], laplacian_8u, bgr_channels[i]);
-    }
-    
-    // 将处理后的三个通道合并回一个BGR图像
+    // 对每个通道独立地进行拉普拉斯滤波，并从原始通道中减去拉普拉斯结果的绝对值
+    // 锐化图像 = 原始图像 - |拉普拉斯结果|
+    // 直接在BGR交错的像素上一次算完，不拆分/合并通道，也不需要CV_16S的中间结果
     Mat result_img;
-    merge(bgr_channels, result_img);
+    laplacian_sharpen_8u(src_img, result_img, BORDER_MODE_REFLECT);
 
     return result_img;
 }
@@ -50,26 +35,13 @@ Mat sharpen_in_hsv_space(const Mat& src_img) {
         return Mat();
     }
 
-    // 将 BGR 图像转换到 HSV 颜色空间
-    Mat hsv_img;
-    cvtColor(src_img, hsv_img, COLOR_BGR2HSV);
-
-    // 将HSV图像分离成三个通道
-    vector<Mat> hsv_channels;
-    split(hsv_img, hsv_channels);
-    Mat& value_channel = hsv_channels[2]; // V - 亮度通道
-
-    // 只对亮度(V)通道进行拉普拉斯滤波和锐化
-    Mat laplacian_result;
-    Laplacian(value_channel, laplacian_result, CV_16S);
-    Mat laplacian_8u;
-    convertScaleAbs(laplacian_result, laplacian_8u);
-    subtract(value_channel, laplacian_8u, value_channel);
-    Mat processed_hsv_img;
-    merge(hsv_channels, processed_hsv_img);
-
+    // 只对亮度(V)通道进行拉普拉斯锐化，H、S保持不变
+    // 直接取 V = max(B,G,R)，锐化后按 V'/V 缩放每个像素的B、G、R，与转到HSV再转回的结果相同，
+    // 但不需要两次颜色空间转换
     Mat result_img;
-    cvtColor(processed_hsv_img, result_img, COLOR_HSV2BGR);
+    filter_value_channel(src_img, result_img, [](const Mat& value, Mat& sharpened) {
+        laplacian_sharpen_8u(value, sharpened, BORDER_MODE_REFLECT);
+    });
 
     return result_img;
 }
@@ -84,6 +56,9 @@ int main() {
     }
 
     Mat result_rgb = sharpen_in_rgb_space(img);
+    double megapixels = img.total() / 1e6;
+    cout << "RGB锐化节省的临时内存: 每百万像素 " << split_sharpen_bytes_per_megapixel(3) / 1e6 << " MB，本图 "
+         << split_sharpen_bytes_per_megapixel(3) * megapixels / 1e6 << " MB" << endl;
     Mat result_hsv = sharpen_in_hsv_space(img);
 
     Mat difference_image;
@@ -2,9 +2,20 @@
 #include <iostream>
 #include <vector>
 #include <opencv2/opencv.hpp>
+#include "fixed_point_convolution.h"
+#include "spatial_executor.h"
+#include "color_filter.h"
 using namespace std;
 using namespace cv;
 
+//8位均值滤波：定点卷积，图像分块多线程计算；边界按镜像(reflect-101)扩展，与cv::blur的默认边界相同
+static void mean_filter_8u(Mat& channel, int kernel_size) {
+    Mat mask(kernel_size, kernel_size, CV_64F, Scalar(1.0 / (kernel_size * kernel_size)));
+    Mat result;
+    run_tiled(FixedPointSpatialFilter(quantize_mask(mask)), channel, result, BORDER_MODE_REFLECT);
+    channel = result;
+}
+
 //在RGB颜色空间中对每个通道独立进行均值平滑
 Mat smooth_in_rgb_space(const Mat& src_img, int kernel_size) {
     cout << "在RGB空间中平滑" << endl;
@@ -22,10 +33,9 @@ Mat smooth_in_rgb_space(const Mat& src_img, int kernel_size) {
     Mat& red_channel = bgr_channels[2];
 
     // 对每个通道独立地进行均值滤波
-    // cv::blur 是均值滤波的函数
-    blur(blue_channel, blue_channel, Size(kernel_size, kernel_size));
-    blur(green_channel, green_channel, Size(kernel_size, kernel_size));
-    blur(red_channel, red_channel, Size(kernel_size, kernel_size));
+    mean_filter_8u(blue_channel, kernel_size);
+    mean_filter_8u(green_channel, kernel_size);
+    mean_filter_8u(red_channel, kernel_size);
     
     // 将处理后的三个通道合并回一个BGR图像
     Mat result_img;
@@ -43,28 +53,14 @@ Mat smooth_in_hsi_space(const Mat& src_img, int kernel_size) {
         return Mat();
     }
 
-    // 将BGR图像转换到 HSV 颜色空间
-    // H(色调), S(饱和度), V(亮度, Value)
-    Mat hsv_img;
-    cvtColor(src_img, hsv_img, COLOR_BGR2HSV);
-
-    // 将HSV图像分离成三个通道
-    vector<Mat> hsv_channels;
-    split(hsv_img, hsv_channels);
-    Mat& hue_channel = hsv_channels[0];         
-    Mat& saturation_channel = hsv_channels[1];  
-    Mat& value_channel = hsv_channels[2];     
-
-    // 只对亮度(V)通道进行均值滤波
-    blur(value_channel, value_channel, Size(kernel_size, kernel_size));
-
-    // 保持 H 和 S 通道不变，将处理后的三个通道合并回来
-    Mat processed_hsv_img;
-    merge(hsv_channels, processed_hsv_img);
-
-    // 将处理后的 HSV 图像转换回 BGR 空间以便显示
+    // 只对亮度(V)通道进行均值滤波，H(色调)、S(饱和度)保持不变
+    // 直接取 V = max(B,G,R)，滤波后按 V'/V 缩放每个像素的B、G、R，与转到HSV再转回的结果相同，
+    // 但不需要两次颜色空间转换
     Mat result_img;
-    cvtColor(processed_hsv_img, result_img, COLOR_HSV2BGR);
+    filter_value_channel(src_img, result_img, [&](const Mat& value, Mat& smoothed) {
+        smoothed = value;
+        mean_filter_8u(smoothed, kernel_size);
+    });
 
     return result_img;
 }
@@ -1,6 +1,7 @@
 //细化:去除冗余的前景像素，同时保持物体的基本形状和连通性，最终得到一个单像素宽度的“骨架”
 //击中或击不中变换:每次迭代的核心操作,我们使用一组预定义的模板，描述安全删除的“边缘像素”的模式。
 #include "otsu.h"
+#include "local_threshold.h"
 #include <iostream>
 #include <vector>
 using namespace std;
@@ -109,9 +110,18 @@ int main() {
     
     Mat thin_result = perform_thinning(binary_img);
 
+    //车牌光照不均匀时全局阈值会丢掉暗处的字符，Sauvola局部阈值按每个像素的邻域均值、标准差定阈值；
+    //车牌是暗底亮字，Sauvola按白纸黑字设计，用LIGHT_ON_DARK让亮的字符为255，细化的是字符而不是底色
+    cout << "Sauvola局部阈值" << endl;
+    Mat sauvola_img;
+    LocalThreshold::sauvola(25, 0.34, 128.0, LOCAL_THRESHOLD_LIGHT_ON_DARK).apply(img_orig, sauvola_img);
+    Mat sauvola_thin = perform_thinning(sauvola_img);
+
     imshow("Original Image", img_orig);       // 显示原始图像
     imshow("Binary Image (Otsu)", binary_img); // 显示二值化后的图像
     imshow("Thinned Image", thin_result);      // 显示细化后的图像
+    imshow("Binary Image (Sauvola)", sauvola_img);
+    imshow("Thinned Image (Sauvola)", sauvola_thin);
 
     waitKey(0);
     return 0;
@@ -2,6 +2,7 @@
 #include <vector>
 #include <numeric>
 #include <opencv2/opencv.hpp>
+#include "otsu.h"
 
 // 引入std和cv命名空间
 using namespace std;
@@ -30,36 +31,9 @@ Mat bgr_to_gray(const Mat& img_bgr) {
 
 //Otsu 二值化
 Mat otsu_binarization(const Mat& img_gray) {
-    // (此处省略了 otsu_threshold 函数的实现，假设它已存在并返回最佳阈值)
-    // 为保持代码完整性，这里粘贴一份精简版
-    vector<int> hist(256, 0);
-    for (int i = 0; i < img_gray.rows; ++i){
-        for (int j = 0; j < img_gray.cols; ++j){
-            hist[img_gray.at<uchar>(i, j)]++;
-        }
-    }
-    long total_pixels = img_gray.rows * img_gray.cols;
-    double max_variance = 0.0;
-    int best_threshold = 0;
-
-    for (int t = 0; t < 256; ++t) {
-        long w0_count = 0; double w0_sum = 0;
-        long w1_count = 0; double w1_sum = 0;
-        for (int i = 0; i <= t; ++i) { w0_count += hist[i]; w0_sum += i * hist[i]; }
-        for (int i = t + 1; i < 256; ++i) { w1_count += hist[i]; w1_sum += i * hist[i]; }
-        if (w0_count == 0 || w1_count == 0) continue;
-        
-        double w0 = (double)w0_count / total_pixels;
-        double w1 = (double)w1_count / total_pixels;
-        double u0 = w0_sum / w0_count;
-        double u1 = w1_sum / w1_count;
-        double variance = w0 * w1 * pow(u0 - u1, 2);
-        
-        if (variance > max_variance) {
-            max_variance = variance;
-            best_threshold = t;
-        }
-    }
+    // 直方图与阈值搜索都由otsu.h中的otsu_threshold完成
+    int best_threshold = otsu_threshold(img_gray);
+    if (best_threshold < 0) return Mat();
     cout << "Otsu 阈值 >> " << best_threshold << endl;
     
     Mat binary_img;
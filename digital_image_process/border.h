@@ -0,0 +1,111 @@
+// border.h
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <opencv2/opencv.hpp>
+
+//空间滤波的边界处理方式
+enum BorderMode {
+    BORDER_MODE_IGNORE = 0,    //模板超出图像的像素不计算，输出置0
+    BORDER_MODE_ZERO = 1,      //图像外的像素视为0
+    BORDER_MODE_REPLICATE = 2, //图像外的像素取最近的边界像素 (aaa|abcd|ddd)
+    BORDER_MODE_REFLECT = 3,   //以边界像素为轴镜像，不重复边界像素 (dcb|abcd|cba)
+    BORDER_MODE_WRAP = 4       //周期延拓 (bcd|abcd|abc)
+};
+
+//编译期的边界策略：map(x, n)把任意坐标映射回[0, n)，零填充时图像外返回-1
+//滤波函数以策略为模板参数，图像内部的像素不调用map，只有边界上的一圈像素才逐点映射
+struct BorderZero {
+    static inline int map(int x, int n) { return (x >= 0 && x < n) ? x : -1; }
+};
+
+struct BorderReplicate {
+    static inline int map(int x, int n) { return x < 0 ? 0 : (x >= n ? n - 1 : x); }
+};
+
+struct BorderReflect {
+    static inline int map(int x, int n) {
+        if (n == 1) return 0;
+        //模板比图像还大时可能要反射多次
+        while (x < 0 || x >= n) x = (x < 0) ? -x : 2 * n - 2 - x;
+        return x;
+    }
+};
+
+struct BorderWrap {
+    static inline int map(int x, int n) {
+        x %= n;
+        return x < 0 ? x + n : x;
+    }
+};
+
+//把运行时的BorderMode分派到编译期策略，f一般是以策略对象为参数的泛型lambda
+//BORDER_MODE_IGNORE按零填充计算，调用者再用clear_ignored_border把边界清零
+template<typename F>
+inline void dispatch_border(BorderMode border, F&& f) {
+    switch (border) {
+    case BORDER_MODE_REPLICATE: f(BorderReplicate()); break;
+    case BORDER_MODE_REFLECT:   f(BorderReflect()); break;
+    case BORDER_MODE_WRAP:      f(BorderWrap()); break;
+    default:                    f(BorderZero()); break;
+    }
+}
+
+//按边界策略把图像扩展为 (width + m_width - 1) x (height + m_height - 1)，
+//上、左各扩展m_height/2、m_width/2；输出(i,j)的窗口就是扩展图像中以(i,j)为左上角的区域
+template<typename Border, typename T>
+void pad_image(const T* src, int width, int height, int m_width, int m_height, std::vector<T>& padded) {
+    int pw = width + m_width - 1;
+    int ph = height + m_height - 1;
+    int top = m_height / 2, left = m_width / 2;
+    padded.assign((size_t)pw * ph, T(0));
+    //列方向的映射对每行都一样，先算好
+    std::vector<int> cols(pw);
+    for (int x = 0; x < pw; ++x) cols[x] = Border::map(x - left, width);
+    for (int y = 0; y < ph; ++y) {
+        int sy = Border::map(y - top, height);
+        if (sy < 0) continue;
+        const T* s = src + (size_t)sy * width;
+        T* d = &padded[(size_t)y * pw];
+        std::copy(s, s + width, d + left);
+        for (int x = 0; x < left; ++x) {
+            if (cols[x] >= 0) d[x] = s[cols[x]];
+        }
+        for (int x = left + width; x < pw; ++x) {
+            if (cols[x] >= 0) d[x] = s[cols[x]];
+        }
+    }
+}
+
+//BORDER_MODE_IGNORE：模板超出图像的位置输出0
+template<typename T>
+void clear_ignored_border(T* dst, int width, int height, int m_width, int m_height) {
+    int ch = m_height / 2, cw = m_width / 2;
+    for (int i = 0; i < height; ++i) {
+        T* d = dst + (size_t)i * width;
+        if (i - ch < 0 || i + ch >= height) {
+            std::fill(d, d + width, T(0));
+            continue;
+        }
+        for (int j = 0; j < width; ++j) {
+            if (j - cw < 0 || j + cw >= width) d[j] = T(0);
+        }
+    }
+}
+
+//同上，用于3x3模板、直接写cv::Mat的融合滤波：首、末两行和每行首、末一个像素置0，任意elemSize
+inline void clear_ignored_border_3x3(cv::Mat& dst) {
+    if (dst.empty()) return;
+    size_t es = dst.elemSize(), bytes = dst.cols * es;
+    for (int i = 0; i < dst.rows; ++i) {
+        uchar* d = dst.ptr<uchar>(i);
+        if (i == 0 || i == dst.rows - 1) {
+            memset(d, 0, bytes);
+        } else {
+            memset(d, 0, es);
+            memset(d + bytes - es, 0, es);
+        }
+    }
+}
@@ -0,0 +1,167 @@
+//限制对比度的自适应直方图均衡化
+#include "clahe.h"
+#include "histogram.h"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+//抽样均值时的行间隔
+const int CLAHE_SAMPLE_STEP = 4;
+
+void equalization_lut(const int* hist, long total, uchar* lut) {
+    double scale_factor = total > 0 ? 255.0 / total : 0.0; // (L-1) / (M*N)
+    long cdf = 0;
+    for (int i = 0; i < 256; ++i) {
+        cdf += hist[i];
+        lut[i] = static_cast<uchar>(round(scale_factor * cdf));
+    }
+}
+
+//截断直方图：超过上限的计数均匀分给256个灰度级，除不尽的余数隔step个灰度级各加1
+static void clip_histogram(int* hist, int limit) {
+    long excess = 0;
+    for (int i = 0; i < 256; ++i) {
+        if (hist[i] > limit) {
+            excess += hist[i] - limit;
+            hist[i] = limit;
+        }
+    }
+    int batch = (int)(excess / 256);
+    int residual = (int)(excess - batch * 256);
+    for (int i = 0; i < 256; ++i) hist[i] += batch;
+    if (residual > 0) {
+        int step = max(256 / residual, 1);
+        for (int i = 0; i < 256 && residual > 0; i += step, --residual) hist[i]++;
+    }
+}
+
+Clahe::Clahe(double clip_limit, Size tiles)
+    : clip_limit_(clip_limit), tiles_(max(tiles.width, 1), max(tiles.height, 1)), reused_tiles_(0) {}
+
+void Clahe::reset() {
+    image_size_ = Size();
+    luts_.clear();
+    means_.clear();
+    reused_tiles_ = 0;
+}
+
+void Clahe::prepare(const Mat& src) {
+    image_size_ = src.size();
+    grid_ = Size(min(tiles_.width, src.cols), min(tiles_.height, src.rows));
+    luts_.assign((size_t)grid_.area() * 256, 0);
+    means_.assign(grid_.area(), 0.0);
+}
+
+//块边界按 k * cols / grid 取整，尺寸不能整除时各块最多相差1个像素
+Rect Clahe::tile_rect(int tx, int ty) const {
+    int x0 = tx * image_size_.width / grid_.width, x1 = (tx + 1) * image_size_.width / grid_.width;
+    int y0 = ty * image_size_.height / grid_.height, y1 = (ty + 1) * image_size_.height / grid_.height;
+    return Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+double Clahe::sample_mean(const Mat& src, const Rect& r) const {
+    long sum = 0, count = 0;
+    for (int i = r.y; i < r.y + r.height; i += CLAHE_SAMPLE_STEP) {
+        const uchar* p = src.ptr<uchar>(i) + r.x;
+        for (int j = 0; j < r.width; ++j) sum += p[j];
+        count += r.width;
+    }
+    return count > 0 ? (double)sum / count : 0.0;
+}
+
+void Clahe::build_lut(const Mat& src, int tile) {
+    Rect r = tile_rect(tile % grid_.width, tile / grid_.width);
+    vector<int> hist;
+    calc_histogram(src, hist, r);
+    if (clip_limit_ > 0) {
+        //上限至少为1，与cv::createCLAHE相同
+        int limit = max((int)(clip_limit_ * r.area() / 256), 1);
+        clip_histogram(hist.data(), limit);
+    }
+    equalization_lut(hist.data(), r.area(), &luts_[(size_t)tile * 256]);
+}
+
+//一遍扫描：每列预先算好左右两块的查找表偏移和权重，每行只需确定上下两块
+void Clahe::interpolate(const Mat& src, Mat& dst) const {
+    dst.create(src.size(), CV_8UC1);
+    float inv_tw = (float)grid_.width / src.cols;
+    float inv_th = (float)grid_.height / src.rows;
+    vector<int> ind1(src.cols), ind2(src.cols);
+    vector<float> xa(src.cols);
+    for (int x = 0; x < src.cols; ++x) {
+        //以块中心为插值节点，图像最外侧半个块只用最近的块
+        float txf = x * inv_tw - 0.5f;
+        int tx1 = (int)floor(txf);
+        int tx2 = tx1 + 1;
+        xa[x] = txf - tx1;
+        tx1 = max(tx1, 0);
+        tx2 = min(tx2, grid_.width - 1);
+        ind1[x] = tx1 * 256;
+        ind2[x] = tx2 * 256;
+    }
+    parallel_for_(Range(0, src.rows), [&](const Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            float tyf = y * inv_th - 0.5f;
+            int ty1 = (int)floor(tyf);
+            int ty2 = ty1 + 1;
+            float ya = tyf - ty1;
+            ty1 = max(ty1, 0);
+            ty2 = min(ty2, grid_.height - 1);
+            const uchar* lut1 = &luts_[(size_t)ty1 * grid_.width * 256];
+            const uchar* lut2 = &luts_[(size_t)ty2 * grid_.width * 256];
+            const uchar* s = src.ptr<uchar>(y);
+            uchar* d = dst.ptr<uchar>(y);
+            for (int x = 0; x < src.cols; ++x) {
+                int v = s[x];
+                float top = lut1[ind1[x] + v] * (1.0f - xa[x]) + lut1[ind2[x] + v] * xa[x];
+                float bottom = lut2[ind1[x] + v] * (1.0f - xa[x]) + lut2[ind2[x] + v] * xa[x];
+                d[x] = saturate_cast<uchar>(top * (1.0f - ya) + bottom * ya);
+            }
+        }
+    });
+}
+
+void Clahe::apply(const Mat& src, Mat& dst) {
+    if (src.type() != CV_8UC1 || src.empty()) {
+        cerr << "错误: CLAHE只支持非空的8位单通道灰度图" << endl;
+        dst = Mat();
+        return;
+    }
+    prepare(src);
+    reused_tiles_ = 0;
+    int tiles = grid_.area();
+    //同时记下每块的抽样均值，之后的apply_incremental以这一帧为基准判断场景是否稳定
+    parallel_for_(Range(0, tiles), [&](const Range& range) {
+        for (int t = range.start; t < range.end; ++t) {
+            means_[t] = sample_mean(src, tile_rect(t % grid_.width, t / grid_.width));
+            build_lut(src, t);
+        }
+    }, tiles);
+    interpolate(src, dst);
+}
+
+void Clahe::apply_incremental(const Mat& src, Mat& dst, double stable_threshold) {
+    if (src.type() != CV_8UC1 || src.empty()) {
+        cerr << "错误: CLAHE只支持非空的8位单通道灰度图" << endl;
+        dst = Mat();
+        return;
+    }
+    bool first = src.size() != image_size_ || luts_.empty();
+    if (first) prepare(src);
+    int tiles = grid_.area();
+    vector<uchar> rebuilt(tiles, 0);
+    parallel_for_(Range(0, tiles), [&](const Range& range) {
+        for (int t = range.start; t < range.end; ++t) {
+            double m = sample_mean(src, tile_rect(t % grid_.width, t / grid_.width));
+            if (!first && fabs(m - means_[t]) <= stable_threshold) continue;
+            means_[t] = m;
+            build_lut(src, t);
+            rebuilt[t] = 1;
+        }
+    }, tiles);
+    reused_tiles_ = tiles - (int)count(rebuilt.begin(), rebuilt.end(), 1);
+    interpolate(src, dst);
+}
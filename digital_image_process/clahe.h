@@ -0,0 +1,47 @@
+// clahe.h
+#pragma once
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+//直方图均衡化的查找表：lut[r] = round( (L-1)/total * cdf(r) )
+//hist为256个灰度级的直方图，total为像素总数
+void equalization_lut(const int* hist, long total, uchar* lut);
+
+//限制对比度的自适应直方图均衡化(CLAHE)，只支持CV_8UC1
+//图像分成 tiles.width x tiles.height 个块，每块的直方图先按clip_limit截断，
+//超出部分均匀分给所有灰度级，再按全局均衡化相同的方法得到该块的查找表；
+//每个像素的输出由周围4个块中心的查找表双线性插值得到，避免块边界处的跳变
+class Clahe {
+public:
+    //clip_limit为每个灰度级的计数上限相对于平均计数(块像素数/256)的倍数，<=0时不截断(普通AHE)
+    explicit Clahe(double clip_limit = 4.0, cv::Size tiles = cv::Size(8, 8));
+
+    //单帧：所有块的直方图并行计算，然后一遍扫描完成插值映射；
+    //同时记录每块的抽样均值，之后可以接着对同尺寸的帧调用apply_incremental
+    void apply(const cv::Mat& src, cv::Mat& dst);
+
+    //视频：与上一帧尺寸相同时，先对每块隔行抽样求均值，变化不超过stable_threshold个灰度级的块
+    //沿用上一帧的直方图(即查找表)，只有变化了的块重新统计；第一帧或尺寸变化时等同于apply
+    void apply_incremental(const cv::Mat& src, cv::Mat& dst, double stable_threshold = 1.0);
+
+    //清除保存的上一帧状态
+    void reset();
+    //上一次apply_incremental沿用旧查找表的块数
+    int reused_tiles() const { return reused_tiles_; }
+
+private:
+    void prepare(const cv::Mat& src);
+    cv::Rect tile_rect(int tx, int ty) const;
+    double sample_mean(const cv::Mat& src, const cv::Rect& r) const;
+    void build_lut(const cv::Mat& src, int tile);
+    void interpolate(const cv::Mat& src, cv::Mat& dst) const;
+
+    double clip_limit_;
+    cv::Size tiles_;     //请求的块数
+    cv::Size grid_;      //实际块数(不超过图像尺寸)
+    cv::Size image_size_;
+    std::vector<uchar> luts_;     //grid_.area() x 256
+    std::vector<double> means_;   //每块抽样均值，用于判断场景是否稳定
+    int reused_tiles_;
+};
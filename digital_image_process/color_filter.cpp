@@ -0,0 +1,185 @@
+//彩色(多通道交错)图像的滤波：不拆分通道，直接在交错的像素上计算
+#include "color_filter.h"
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLOR_HAVE_SSE2 1
+#endif
+
+using namespace std;
+using namespace cv;
+
+//---------------- 拉普拉斯锐化 ----------------
+
+static inline uchar sharpen_value(int center, int sum4) {
+    int lap = min(abs(sum4 - 4 * center), 255);
+    return (uchar)max(center - lap, 0);
+}
+
+//up、row、down为相邻三行，只计算第begin到end个字节(左右邻居都在行内)
+static void sharpen_row_interior(const uchar* up, const uchar* row, const uchar* down,
+                                 uchar* dst, int cn, int begin, int end) {
+    int k = begin;
+#ifdef COLOR_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128(), max8 = _mm_set1_epi16(255);
+    auto lap16 = [&](__m128i u, __m128i d, __m128i l, __m128i r, __m128i c) {
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(u, d), _mm_add_epi16(l, r));
+        __m128i lap = _mm_sub_epi16(sum, _mm_slli_epi16(c, 2));
+        return _mm_min_epi16(_mm_max_epi16(lap, _mm_sub_epi16(zero, lap)), max8);
+    };
+    for (; k + 16 <= end; k += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + k));
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + k - cn));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + k + cn));
+        __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + k));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + k));
+        __m128i lo = lap16(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(l, zero),
+                           _mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(c, zero));
+        __m128i hi = lap16(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(l, zero),
+                           _mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(c, zero));
+        //饱和减法：c - min(|L|,255)，小于0时为0
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), _mm_subs_epu8(c, _mm_packus_epi16(lo, hi)));
+    }
+#endif
+    for (; k < end; ++k) {
+        dst[k] = sharpen_value(row[k], up[k] + down[k] + row[k - cn] + row[k + cn]);
+    }
+}
+
+template<typename Border>
+static void sharpen_rows(const Mat& src, Mat& dst, const uchar* zeros, int begin, int end) {
+    int width = src.cols, height = src.rows, cn = src.channels();
+    int bytes = width * cn;
+    int left = Border::map(-1, width), right = Border::map(width, width);
+    for (int i = begin; i < end; ++i) {
+        int y_up = Border::map(i - 1, height), y_down = Border::map(i + 1, height);
+        const uchar* up = y_up < 0 ? zeros : src.ptr<uchar>(y_up);
+        const uchar* row = src.ptr<uchar>(i);
+        const uchar* down = y_down < 0 ? zeros : src.ptr<uchar>(y_down);
+        uchar* d = dst.ptr<uchar>(i);
+        //第一列和最后一列的左右邻居按border取，其余都在行内
+        auto edge_pixel = [&](int x) {
+            int xl = x == 0 ? left : x - 1, xr = x == width - 1 ? right : x + 1;
+            for (int c = 0; c < cn; ++c) {
+                int k = x * cn + c;
+                int l = xl < 0 ? 0 : row[xl * cn + c], r = xr < 0 ? 0 : row[xr * cn + c];
+                d[k] = sharpen_value(row[k], up[k] + down[k] + l + r);
+            }
+        };
+        edge_pixel(0);
+        if (width > 1) edge_pixel(width - 1);
+        if (width > 2) sharpen_row_interior(up, row, down, d, cn, cn, bytes - cn);
+    }
+}
+
+void laplacian_sharpen_8u(const Mat& src, Mat& dst, BorderMode border) {
+    if (src.depth() != CV_8U || src.channels() > 4) {
+        cerr << "错误: 锐化只支持1~4通道的8位图像" << endl;
+        dst = Mat();
+        return;
+    }
+    if (src.empty()) {
+        dst = Mat();
+        return;
+    }
+    //原地处理时先复制输入，计算每行都要用到上下两行的原始值
+    Mat input = (src.data == dst.data) ? src.clone() : src;
+    dst.create(src.size(), src.type());
+    vector<uchar> zeros((size_t)src.cols * src.channels(), 0); //零填充时图像外的行
+    dispatch_border(border, [&](auto policy) {
+        parallel_for_(Range(0, src.rows), [&](const Range& r) {
+            sharpen_rows<decltype(policy)>(input, dst, zeros.data(), r.start, r.end);
+        });
+    });
+    //模板超出图像的位置置0
+    if (border == BORDER_MODE_IGNORE) clear_ignored_border_3x3(dst);
+}
+
+size_t split_sharpen_bytes_per_megapixel(int channels) {
+    //split得到的通道平面(每像素cn字节) + Laplacian的CV_16S结果(2字节) + convertScaleAbs的8位结果(1字节)
+    return (size_t)(channels + 2 + 1) * 1000000;
+}
+
+//---------------- 亮度通道 ----------------
+
+//一行像素乘以各自的增益：d = round(c * V'/V)，V = 0时(此时B、G、R都为0)输出灰色(V',V',V')
+//c <= V，结果不超过V' <= 255，不需要饱和
+static void apply_value_gain_row(const uchar* s, const uchar* v, const uchar* f, uchar* d, int width) {
+    int j = 0;
+#ifdef COLOR_HAVE_SSE2
+    //每次4个像素(12个字节)：增益在float中计算，再按BGR交错展开成 g0 g0 g0 g1 | g1 g1 g2 g2 | g2 g3 g3 g3
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 one = _mm_set1_ps(1.0f);
+    auto load4 = [&](const uchar* p) {
+        int bits;
+        memcpy(&bits, p, 4);
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero));
+    };
+    for (; j + 6 <= width; j += 4) { //一次读16个字节，保证不越过行尾
+        __m128 vv = load4(v + j), ff = load4(f + j);
+        __m128 gain = _mm_div_ps(ff, _mm_max_ps(vv, one));
+        __m128 gray = _mm_and_ps(_mm_cmpeq_ps(vv, _mm_setzero_ps()), ff);
+        __m128 g0 = _mm_shuffle_ps(gain, gain, _MM_SHUFFLE(1, 0, 0, 0));
+        __m128 g1 = _mm_shuffle_ps(gain, gain, _MM_SHUFFLE(2, 2, 1, 1));
+        __m128 g2 = _mm_shuffle_ps(gain, gain, _MM_SHUFFLE(3, 3, 3, 2));
+        __m128 y0 = _mm_shuffle_ps(gray, gray, _MM_SHUFFLE(1, 0, 0, 0));
+        __m128 y1 = _mm_shuffle_ps(gray, gray, _MM_SHUFFLE(2, 2, 1, 1));
+        __m128 y2 = _mm_shuffle_ps(gray, gray, _MM_SHUFFLE(3, 3, 3, 2));
+
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 3 * j));
+        __m128i lo = _mm_unpacklo_epi8(px, zero), hi = _mm_unpackhi_epi8(px, zero);
+        __m128 c0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        __m128 c1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        __m128 c2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        __m128i r0 = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(c0, g0), y0));
+        __m128i r1 = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(c1, g1), y1));
+        __m128i r2 = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(c2, g2), y2));
+        __m128i r = _mm_packus_epi16(_mm_packs_epi32(r0, r1), _mm_packs_epi32(r2, r2));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(d + 3 * j), r);
+        int tail = _mm_cvtsi128_si32(_mm_srli_si128(r, 8));
+        memcpy(d + 3 * j + 8, &tail, 4);
+    }
+#endif
+    //与SIMD相同的float计算，cvRound按最近偶数舍入
+    for (; j < width; ++j) {
+        float gain = (float)f[j] / max((int)v[j], 1);
+        float gray = v[j] == 0 ? (float)f[j] : 0.0f;
+        for (int c = 0; c < 3; ++c) d[3 * j + c] = (uchar)cvRound(s[3 * j + c] * gain + gray);
+    }
+}
+
+void filter_value_channel(const Mat& src, Mat& dst, const ValueFilter& filter) {
+    if (src.type() != CV_8UC3) {
+        cerr << "错误: 输入图像必须是8位3通道彩色图" << endl;
+        dst = Mat();
+        return;
+    }
+    int width = src.cols;
+    Mat value(src.size(), CV_8UC1);
+    parallel_for_(Range(0, src.rows), [&](const Range& r) {
+        for (int i = r.start; i < r.end; ++i) {
+            const uchar* s = src.ptr<uchar>(i);
+            uchar* v = value.ptr<uchar>(i);
+            for (int j = 0; j < width; ++j) v[j] = max(s[3 * j], max(s[3 * j + 1], s[3 * j + 2]));
+        }
+    });
+
+    Mat filtered;
+    filter(value, filtered);
+    if (filtered.size() != src.size() || filtered.type() != CV_8UC1) {
+        cerr << "错误: 亮度滤波的输出必须与输入同尺寸的CV_8UC1" << endl;
+        dst = Mat();
+        return;
+    }
+
+    //dst可以就是src：每个像素先读后写
+    dst.create(src.size(), CV_8UC3);
+    parallel_for_(Range(0, src.rows), [&](const Range& r) {
+        for (int i = r.start; i < r.end; ++i) {
+            apply_value_gain_row(src.ptr<uchar>(i), value.ptr<uchar>(i), filtered.ptr<uchar>(i), dst.ptr<uchar>(i), width);
+        }
+    });
+}
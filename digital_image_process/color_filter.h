@@ -0,0 +1,26 @@
+// color_filter.h
+#pragma once
+
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include "border.h"
+
+//交错存放的8位图像(CV_8UC1 ~ CV_8UC4，如BGR)的拉普拉斯锐化，每个通道：
+//dst = saturate(src - min(|L|, 255))，L为4邻域拉普拉斯 (0 1 0 / 1 -4 1 / 0 1 0)
+//与 split + Laplacian(CV_16S) + convertScaleAbs + subtract + merge 的结果相同(border取BORDER_MODE_REFLECT时)
+//直接在交错的像素上计算：同一通道左右相邻的像素相隔cn个字节，每16个字节一组用SSE2计算，
+//一次扫描，除dst外不需要任何临时图像；dst尺寸、类型正确时直接写入，逐帧处理时不重新分配
+void laplacian_sharpen_8u(const cv::Mat& src, cv::Mat& dst, BorderMode border = BORDER_MODE_REFLECT);
+
+//拆分/合并方式每百万像素需要的临时内存(字节)：
+//cn个通道平面 + 一个通道的CV_16S拉普拉斯结果 + 8位绝对值；融合方式为0
+size_t split_sharpen_bytes_per_megapixel(int channels);
+
+//只处理亮度的滤波：filter的输入为V = max(B,G,R)平面(CV_8UC1)，输出同尺寸的CV_8UC1
+typedef std::function<void(const cv::Mat& value, cv::Mat& filtered)> ValueFilter;
+
+//对BGR图像(CV_8UC3)只处理HSV中的V分量，H、S不变：
+//1. 取出V平面  2. filter(V) = V'  3. 每个像素的B、G、R乘以增益 V'/V (SSE2每次4个像素)，V = 0时为灰色(V',V',V')
+//H、S不变时HSV转回BGR恰好是按V等比例缩放，所以与 cvtColor(BGR2HSV) → 只处理V → cvtColor(HSV2BGR) 等价，
+//但不需要两次颜色空间转换(色调的分段计算和除法)，也没有H、S量化到8位的误差
+void filter_value_channel(const cv::Mat& src, cv::Mat& dst, const ValueFilter& filter);
@@ -0,0 +1,393 @@
+//二维卷积：直接计算、盒子滤波、可分离模板的两遍一维卷积与FFT快速卷积，按估算的计算量自动选择；
+//边界处理由border.h中的编译期策略完成，图像内部的循环不判断越界
+#include "convolution.h"
+#include "fft_plan.h"
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+//---------------- 计算量估算 ----------------
+//常数由3.convolution_benchmark.cpp实测得到：直接法每次乘加约1个单位，
+//FFT法每个补零后像素每级log2约CONV_FFT_UNIT个单位(三次实数FFT加一次频谱相乘)
+const double CONV_DIRECT_UNIT = 1.0;
+const double CONV_FFT_UNIT = 4.0;
+const double CONV_SEPARABLE_OVERHEAD = 4.0; //中间缓冲区的读写，3x3模板时两遍一维卷积并不比直接计算快
+const double CONV_BOX_UNIT = 6.0;           //每个像素竖直、水平各一加一减，再加一次乘法
+
+double conv_direct_cost(int width, int height, int m_width, int m_height) {
+    return CONV_DIRECT_UNIT * (double)width * height * m_width * m_height;
+}
+
+double conv_fft_cost(int width, int height, int m_width, int m_height) {
+    double rows = getOptimalDFTSize(height + m_height - 1);
+    double cols = getOptimalDFTSize(width + m_width - 1);
+    return CONV_FFT_UNIT * rows * cols * log2(rows * cols);
+}
+
+double conv_separable_cost(int width, int height, int m_width, int m_height) {
+    return CONV_DIRECT_UNIT * (double)width * height * (m_width + m_height + CONV_SEPARABLE_OVERHEAD);
+}
+
+double conv_box_cost(int width, int height) {
+    return CONV_BOX_UNIT * (double)width * height;
+}
+
+ConvMethod choose_conv_method(int width, int height, int m_width, int m_height, bool separable, bool constant) {
+    double direct = conv_direct_cost(width, height, m_width, m_height);
+    double fft = conv_fft_cost(width, height, m_width, m_height);
+    if (constant && conv_box_cost(width, height) < min(direct, fft)) {
+        return CONV_BOX;
+    }
+    if (separable && conv_separable_cost(width, height, m_width, m_height) < min(direct, fft)) {
+        return CONV_SEPARABLE;
+    }
+    return fft < direct ? CONV_FFT : CONV_DIRECT;
+}
+
+//---------------- 直接计算 ----------------
+
+//图像内部：模板完全落在图像内的区域 [i_begin, i_end) x [j_begin, j_end)
+struct InteriorRegion {
+    int i_begin, i_end, j_begin, j_end;
+    InteriorRegion(int width, int height, int m_width, int m_height) {
+        i_begin = min(m_height / 2, height);
+        i_end = max(i_begin, height - (m_height - 1 - m_height / 2));
+        j_begin = min(m_width / 2, width);
+        j_end = max(j_begin, width - (m_width - 1 - m_width / 2));
+    }
+};
+
+//d[j] += s[j] * k，两段不重叠，循环里没有分支，可以自动向量化
+static inline void multiply_add(double* __restrict d, const double* __restrict s, double k, int n) {
+    for (int j = 0; j < n; j++) d[j] += s[j] * k;
+}
+
+//边界上的一个像素：每个模板位置都按策略映射坐标，零填充时跳过图像外的位置
+template<typename Border>
+static inline double convolve_pixel(const double* src, const double* mask, int width, int height,
+                                    int m_width, int m_height, int i, int j) {
+    int mask_center_h = m_height / 2;
+    int mask_center_w = m_width / 2;
+    double value = 0.0;
+    for (int n = 0; n < m_height; n++) {
+        int y = Border::map(i + n - mask_center_h, height);
+        if (y < 0) continue;
+        const double* s = src + (size_t)y * width;
+        const double* k = mask + (size_t)n * m_width;
+        for (int m = 0; m < m_width; m++) {
+            int x = Border::map(j + m - mask_center_w, width);
+            if (x >= 0) value += s[x] * k[m];
+        }
+    }
+    return value;
+}
+
+//内部按整行累加：对每个模板位置(n,m)，把整段输入行乘以mask(n,m)加到输出行上；
+//每个像素的求和顺序仍是先n后m，与逐点计算的结果完全相同
+template<typename Border>
+static void convolve_direct(const double* src, double* dst, const double* mask,
+                            int width, int height, int m_width, int m_height) {
+    int mask_center_h = m_height / 2;
+    int mask_center_w = m_width / 2;
+    InteriorRegion r(width, height, m_width, m_height);
+    int span = r.j_end - r.j_begin;
+    for (int i = 0; i < height; i++) {
+        double* d = dst + (size_t)i * width;
+        if (i < r.i_begin || i >= r.i_end) {
+            for (int j = 0; j < width; j++) {
+                d[j] = convolve_pixel<Border>(src, mask, width, height, m_width, m_height, i, j);
+            }
+            continue;
+        }
+        for (int j = 0; j < r.j_begin; j++) {
+            d[j] = convolve_pixel<Border>(src, mask, width, height, m_width, m_height, i, j);
+        }
+        for (int j = r.j_end; j < width; j++) {
+            d[j] = convolve_pixel<Border>(src, mask, width, height, m_width, m_height, i, j);
+        }
+        fill(d + r.j_begin, d + r.j_end, 0.0);
+        for (int n = 0; n < m_height; n++) {
+            const double* s = src + (size_t)(i + n - mask_center_h) * width + (r.j_begin - mask_center_w);
+            const double* k = mask + (size_t)n * m_width;
+            for (int m = 0; m < m_width; m++) multiply_add(d + r.j_begin, s + m, k[m], span);
+        }
+    }
+}
+
+//---------------- 可分离模板 ----------------
+
+//取绝对值最大的元素 mask(n0,m0) 所在的行、列作为两个一维模板：
+//kernel_x[m] = mask(n0,m)，kernel_y[n] = mask(n,m0) / mask(n0,m0)，再逐点检验 kernel_y[n] * kernel_x[m]
+bool separate_kernel(const double* mask, int m_width, int m_height,
+                     double* kernel_x, double* kernel_y, double tol) {
+    int size = m_width * m_height;
+    if (size <= 0) return false;
+    int pivot = 0;
+    for (int k = 1; k < size; k++) {
+        if (fabs(mask[k]) > fabs(mask[pivot])) pivot = k;
+    }
+    double peak = mask[pivot];
+    if (peak == 0.0) return false;
+    int n0 = pivot / m_width;
+    int m0 = pivot % m_width;
+    for (int m = 0; m < m_width; m++) kernel_x[m] = mask[(size_t)n0 * m_width + m];
+    for (int n = 0; n < m_height; n++) kernel_y[n] = mask[(size_t)n * m_width + m0] / peak;
+
+    double limit = tol * fabs(peak);
+    for (int n = 0; n < m_height; n++) {
+        for (int m = 0; m < m_width; m++) {
+            if (fabs(mask[(size_t)n * m_width + m] - kernel_y[n] * kernel_x[m]) > limit) return false;
+        }
+    }
+    return true;
+}
+
+//水平一维卷积：每行内部整段累加，两端的像素按策略映射
+template<typename Border>
+static void convolve_rows(const double* src, double* dst, const double* kernel, int m_width,
+                          int width, int height) {
+    int center = m_width / 2;
+    InteriorRegion r(width, 1, m_width, 1);
+    int span = r.j_end - r.j_begin;
+    auto border_pixel = [&](const double* s, int j) {
+        double value = 0.0;
+        for (int m = 0; m < m_width; m++) {
+            int x = Border::map(j + m - center, width);
+            if (x >= 0) value += s[x] * kernel[m];
+        }
+        return value;
+    };
+    for (int i = 0; i < height; i++) {
+        const double* s = src + (size_t)i * width;
+        double* d = dst + (size_t)i * width;
+        for (int j = 0; j < r.j_begin; j++) d[j] = border_pixel(s, j);
+        for (int j = r.j_end; j < width; j++) d[j] = border_pixel(s, j);
+        fill(d + r.j_begin, d + r.j_end, 0.0);
+        for (int m = 0; m < m_width; m++) multiply_add(d + r.j_begin, s + r.j_begin - center + m, kernel[m], span);
+    }
+}
+
+//竖直一维卷积：输出的每一行是若干输入行的加权和，按整行连续访问，不需要转置；
+//边界只影响取哪些行，每行只映射m_height次
+template<typename Border>
+static void convolve_columns(const double* src, double* dst, const double* kernel, int m_height,
+                             int width, int height) {
+    int center = m_height / 2;
+    for (int i = 0; i < height; i++) {
+        double* d = dst + (size_t)i * width;
+        fill(d, d + width, 0.0);
+        for (int n = 0; n < m_height; n++) {
+            int y = Border::map(i + n - center, height);
+            if (y < 0) continue;
+            multiply_add(d, src + (size_t)y * width, kernel[n], width);
+        }
+    }
+}
+
+void convolve_separable(const double* src, double* dst, const double* kernel_x, int m_width,
+                        const double* kernel_y, int m_height, int width, int height, BorderMode border) {
+    if (width <= 0 || height <= 0 || m_width <= 0 || m_height <= 0) return;
+    vector<double> tmp((size_t)width * height);
+    dispatch_border(border, [&](auto policy) {
+        typedef decltype(policy) Border;
+        convolve_rows<Border>(src, tmp.data(), kernel_x, m_width, width, height);
+        convolve_columns<Border>(tmp.data(), dst, kernel_y, m_height, width, height);
+    });
+    if (border == BORDER_MODE_IGNORE) clear_ignored_border(dst, width, height, m_width, m_height);
+}
+
+//---------------- 盒子滤波 ----------------
+
+//col_sum[j]保存第j列当前窗口内(竖直方向)的和，每输出一行只加入新进入窗口的一行、减去离开的一行；
+//再在col_sum上做水平滑动和。窗口超出图像的部分视为0，与RealCOV的零填充一致
+static void convolve_box_zero(const double* src, double* dst, int width, int height,
+                              int m_width, int m_height, double value) {
+    int center_h = m_height / 2;
+    int center_w = m_width / 2;
+    vector<double> col_sum(width, 0.0);
+    //第0行的窗口为 [-center_h, m_height - center_h)
+    for (int y = 0; y < min(m_height - center_h, height); y++) {
+        const double* s = src + (size_t)y * width;
+        for (int j = 0; j < width; j++) col_sum[j] += s[j];
+    }
+    for (int i = 0; i < height; i++) {
+        if (i > 0) {
+            int enter = i + m_height - center_h - 1;
+            int leave = i - center_h - 1;
+            if (enter < height) {
+                const double* s = src + (size_t)enter * width;
+                for (int j = 0; j < width; j++) col_sum[j] += s[j];
+            }
+            if (leave >= 0) {
+                const double* s = src + (size_t)leave * width;
+                for (int j = 0; j < width; j++) col_sum[j] -= s[j];
+            }
+        }
+        double* d = dst + (size_t)i * width;
+        double window = 0.0;
+        for (int x = 0; x < min(m_width - center_w, width); x++) window += col_sum[x];
+        for (int j = 0; j < width; j++) {
+            if (j > 0) {
+                int enter = j + m_width - center_w - 1;
+                int leave = j - center_w - 1;
+                if (enter < width) window += col_sum[enter];
+                if (leave >= 0) window -= col_sum[leave];
+            }
+            d[j] = value * window;
+        }
+    }
+}
+
+//---------------- 其他边界 ----------------
+
+//盒子滤波和FFT只实现了零填充：其他边界先按策略把图像扩展 m-1 个像素，
+//在扩展后的图像上零填充计算，再截取中间的部分；这部分像素的窗口完全落在扩展图像内，零填充不起作用
+template<typename F>
+static void convolve_padded(const double* src, double* dst, int width, int height,
+                            int m_width, int m_height, BorderMode border, F zero_padding) {
+    if (border == BORDER_MODE_ZERO || border == BORDER_MODE_IGNORE) {
+        zero_padding(src, dst, width, height);
+        if (border == BORDER_MODE_IGNORE) clear_ignored_border(dst, width, height, m_width, m_height);
+        return;
+    }
+    vector<double> padded;
+    dispatch_border(border, [&](auto policy) {
+        pad_image<decltype(policy)>(src, width, height, m_width, m_height, padded);
+    });
+    int pw = width + m_width - 1, ph = height + m_height - 1;
+    vector<double> result((size_t)pw * ph);
+    zero_padding(padded.data(), result.data(), pw, ph);
+    int top = m_height / 2, left = m_width / 2;
+    for (int i = 0; i < height; i++) {
+        const double* r = &result[(size_t)(i + top) * pw + left];
+        copy(r, r + width, dst + (size_t)i * width);
+    }
+}
+
+void convolve_box(const double* src, double* dst, int width, int height,
+                  int m_width, int m_height, double value, BorderMode border) {
+    if (width <= 0 || height <= 0 || m_width <= 0 || m_height <= 0) return;
+    convolve_padded(src, dst, width, height, m_width, m_height, border,
+                    [&](const double* s, double* d, int w, int h) {
+                        convolve_box_zero(s, d, w, h, m_width, m_height, value);
+                    });
+}
+
+//---------------- FFT快速卷积 ----------------
+
+//补零到 P >= height + m_height - 1、Q >= width + m_width - 1，循环卷积在有效区域内与线性卷积相同
+//模板不翻转，相当于与翻转后的核做卷积：mask(n,m) 放在 ((ch - n) mod P, (cw - m) mod Q)
+static void convolve_fft(const double* src, double* dst, const double* mask,
+                         int width, int height, int m_width, int m_height) {
+    int rows = getOptimalDFTSize(height + m_height - 1);
+    int cols = getOptimalDFTSize(width + m_width - 1);
+    RealFFTPlan2D image(rows, cols);
+    RealFFTPlan2D kernel(rows, cols);
+
+    for (int i = 0; i < rows; i++) {
+        double* r = image.real_row(i);
+        if (i < height) {
+            copy(src + (size_t)i * width, src + (size_t)(i + 1) * width, r);
+            fill(r + width, r + cols, 0.0);
+        } else {
+            fill(r, r + cols, 0.0);
+        }
+        fill(kernel.real_row(i), kernel.real_row(i) + cols, 0.0);
+    }
+    int mask_center_h = m_height / 2;
+    int mask_center_w = m_width / 2;
+    for (int n = 0; n < m_height; n++) {
+        int y = (mask_center_h - n + rows) % rows;
+        for (int m = 0; m < m_width; m++) {
+            int x = (mask_center_w - m + cols) % cols;
+            kernel.real_row(y)[x] = mask[(size_t)n * m_width + m];
+        }
+    }
+
+    image.forward();
+    kernel.forward();
+    for (int i = 0; i < rows; i++) {
+        complex<double>* a = image.spectrum_row(i);
+        const complex<double>* b = kernel.spectrum_row(i);
+        for (int j = 0; j < image.spectrum_cols(); j++) a[j] *= b[j];
+    }
+    image.inverse();
+
+    for (int i = 0; i < height; i++) {
+        const double* r = image.real_row(i);
+        copy(r, r + width, dst + (size_t)i * width);
+    }
+}
+
+//---------------- 对外接口 ----------------
+
+void convolve(const double* src, double* dst, const double* mask,
+              int width, int height, int m_width, int m_height, BorderMode border, ConvMethod method) {
+    if (width <= 0 || height <= 0 || m_width <= 0 || m_height <= 0) return;
+    int size = m_width * m_height;
+    bool constant = all_of(mask, mask + size, [&](double v) { return v == mask[0]; });
+    vector<double> kernel_x, kernel_y;
+    bool separable = false;
+    if (method == CONV_AUTO || method == CONV_SEPARABLE) {
+        kernel_x.resize(m_width);
+        kernel_y.resize(m_height);
+        separable = separate_kernel(mask, m_width, m_height, kernel_x.data(), kernel_y.data());
+    }
+    if (method == CONV_AUTO) method = choose_conv_method(width, height, m_width, m_height, separable, constant);
+    if (method == CONV_SEPARABLE && !separable) {
+        cerr << "警告: 模板不可分离，改用直接计算" << endl;
+        method = CONV_DIRECT;
+    }
+    if (method == CONV_BOX && !constant) {
+        cerr << "警告: 模板元素不全相等，不能用盒子滤波，改用直接计算" << endl;
+        method = CONV_DIRECT;
+    }
+    if (method == CONV_BOX) {
+        convolve_box(src, dst, width, height, m_width, m_height, mask[0], border);
+    } else if (method == CONV_SEPARABLE) {
+        convolve_separable(src, dst, kernel_x.data(), m_width, kernel_y.data(), m_height, width, height, border);
+    } else if (method == CONV_FFT) {
+        convolve_padded(src, dst, width, height, m_width, m_height, border,
+                        [&](const double* s, double* d, int w, int h) {
+                            convolve_fft(s, d, mask, w, h, m_width, m_height);
+                        });
+    } else {
+        dispatch_border(border, [&](auto policy) {
+            convolve_direct<decltype(policy)>(src, dst, mask, width, height, m_width, m_height);
+        });
+        if (border == BORDER_MODE_IGNORE) clear_ignored_border(dst, width, height, m_width, m_height);
+    }
+}
+
+void convolve_zero_padding(const double* src, double* dst, const double* mask,
+                           int width, int height, int m_width, int m_height, ConvMethod method) {
+    convolve(src, dst, mask, width, height, m_width, m_height, BORDER_MODE_ZERO, method);
+}
+
+void convolve(const Mat& src, Mat& dst, const Mat& mask, BorderMode border, ConvMethod method) {
+    if ((src.type() != CV_8UC1 && src.type() != CV_64FC1) || mask.type() != CV_64FC1) {
+        cerr << "错误: 卷积输入必须是CV_8UC1或CV_64FC1，模板必须是CV_64FC1" << endl;
+        dst = Mat();
+        return;
+    }
+    Mat src_64f;
+    if (src.type() == CV_64FC1 && src.isContinuous()) {
+        src_64f = src;
+    } else {
+        src.convertTo(src_64f, CV_64F); //convertTo的结果是连续的
+    }
+    Mat mask_64f = mask.isContinuous() ? mask : mask.clone();
+    Mat result(src.size(), CV_64F);
+    convolve(src_64f.ptr<double>(), result.ptr<double>(), mask_64f.ptr<double>(),
+             src.cols, src.rows, mask.cols, mask.rows, border, method);
+    dst = result;
+}
+
+void convolve_zero_padding(const Mat& src, Mat& dst, const Mat& mask, ConvMethod method) {
+    convolve(src, dst, mask, BORDER_MODE_ZERO, method);
+}
@@ -0,0 +1,58 @@
+// convolution.h
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "border.h"
+
+//卷积的计算方式
+enum ConvMethod {
+    CONV_AUTO = 0,   //按估算的计算量自动选择
+    CONV_DIRECT = 1, //直接按模板逐点乘加，O(W*H*m*n)
+    CONV_FFT = 2,    //频率域相乘，O(P*Q*log(P*Q))，P、Q为补零后的尺寸
+    CONV_SEPARABLE = 3, //可分离(秩为1)的模板先做水平一维卷积再做竖直一维卷积，O(W*H*(m+n))
+    CONV_BOX = 4       //所有元素相等的模板(均值滤波)用滑动窗口求和，O(W*H)，与模板尺寸无关
+};
+
+//二维卷积(与RealCOV相同，模板不翻转)：
+//dst(i,j) = sum src(i + n - m_height/2, j + m - m_width/2) * mask(n,m)，越界的像素按border处理
+//src、dst为 width x height 的行优先数组，mask为 m_width x m_height
+//大模板时FFT方式快得多，结果与直接计算只差舍入误差(约1e-12 * sum|src|*|mask|)
+void convolve(const double* src, double* dst, const double* mask,
+              int width, int height, int m_width, int m_height,
+              BorderMode border, ConvMethod method = CONV_AUTO);
+
+//零填充：越界的像素视为0
+void convolve_zero_padding(const double* src, double* dst, const double* mask,
+                           int width, int height, int m_width, int m_height,
+                           ConvMethod method = CONV_AUTO);
+
+//模板是否可分离：mask(n,m) = kernel_y[n] * kernel_x[m]，相对误差不超过tol时返回true
+//kernel_x长m_width，kernel_y长m_height；不可分离时返回false，两个数组内容不确定
+bool separate_kernel(const double* mask, int m_width, int m_height,
+                     double* kernel_x, double* kernel_y, double tol = 1e-12);
+
+//可分离模板的卷积：先对每行做kernel_x的一维卷积，再对每列做kernel_y的一维卷积
+//各种边界下两次一维卷积都与二维卷积等价；竖直方向按整行累加，不需要转置
+void convolve_separable(const double* src, double* dst, const double* kernel_x, int m_width,
+                        const double* kernel_y, int m_height, int width, int height,
+                        BorderMode border = BORDER_MODE_ZERO);
+
+//盒子滤波：模板所有元素都等于value，dst = value * 窗口内像素之和
+//value = 1/(m_width*m_height)时就是均值滤波；用逐列的滑动和再做水平滑动和，每个像素只需常数次加减
+void convolve_box(const double* src, double* dst, int width, int height,
+                  int m_width, int m_height, double value, BorderMode border = BORDER_MODE_ZERO);
+
+//Mat版本：src为CV_8UC1或CV_64FC1，mask为CV_64FC1，dst为CV_64FC1
+void convolve(const cv::Mat& src, cv::Mat& dst, const cv::Mat& mask,
+              BorderMode border, ConvMethod method = CONV_AUTO);
+void convolve_zero_padding(const cv::Mat& src, cv::Mat& dst, const cv::Mat& mask,
+                           ConvMethod method = CONV_AUTO);
+
+//各种方式的估算耗时(相对单位，同一量纲)，CONV_AUTO选较小的一个
+double conv_direct_cost(int width, int height, int m_width, int m_height);
+double conv_fft_cost(int width, int height, int m_width, int m_height);
+double conv_separable_cost(int width, int height, int m_width, int m_height);
+double conv_box_cost(int width, int height);
+//separable为true时把可分离方式也算进去，constant为true(所有元素相等)时再算上盒子滤波
+ConvMethod choose_conv_method(int width, int height, int m_width, int m_height,
+                              bool separable = false, bool constant = false);
@@ -0,0 +1,833 @@
+#include "fft_plan.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#define FFT_HAVE_X86_SIMD 1
+#endif
+using namespace std;
+using namespace cv;
+
+//GCC/Clang下AVX2核函数单独打开avx2/fma指令，并把模板核函数整体内联进来；MSVC直接使用内建函数
+#if defined(FFT_HAVE_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#define FFT_AVX2_TARGET __attribute__((target("avx2,fma")))
+#define FFT_AVX2_ENTRY __attribute__((target("avx2,fma"), flatten))
+#pragma GCC diagnostic ignored "-Wpsabi"
+#else
+#define FFT_AVX2_TARGET
+#define FFT_AVX2_ENTRY
+#endif
+
+//---------------- 指令集选择 ----------------
+
+static FFTSimdLevel detect_simd_level() {
+#ifdef FFT_HAVE_X86_SIMD
+    if (checkHardwareSupport(CV_CPU_AVX2) && checkHardwareSupport(CV_CPU_FMA3)) return FFT_SIMD_AVX2;
+    return FFT_SIMD_SSE2;
+#else
+    return FFT_SIMD_SCALAR;
+#endif
+}
+
+//变换线程读取时，设置函数可能在其他线程写入，用原子变量
+static atomic<int> g_simd_limit(FFT_SIMD_AVX2);
+
+FFTSimdLevel fft_simd_level() {
+    static const FFTSimdLevel supported = detect_simd_level();
+    return min(supported, (FFTSimdLevel)g_simd_limit.load(memory_order_relaxed));
+}
+
+void fft_set_simd_level(FFTSimdLevel level) {
+    g_simd_limit.store(level, memory_order_relaxed);
+}
+
+//---------------- 多线程 ----------------
+
+static atomic<int> g_num_threads(0);
+
+int fft_num_threads() {
+    int n = g_num_threads.load(memory_order_relaxed);
+    return n > 0 ? n : max(getNumThreads(), 1);
+}
+
+void fft_set_num_threads(int n) {
+    g_num_threads.store(n, memory_order_relaxed);
+}
+
+//把 [0, n) 分成至多fft_num_threads()段交给OpenCV线程池，body(begin, end)处理其中一段
+//单线程或只有一项时直接在当前线程执行
+template<class Body>
+static void fft_parallel(int n, const Body& body) {
+    int stripes = min(fft_num_threads(), n);
+    if (stripes <= 1) {
+        body(0, n);
+        return;
+    }
+    parallel_for_(Range(0, n), [&](const Range& r) { body(r.start, r.end); }, stripes);
+}
+
+//---------------- 向量类型封装 ----------------
+//每种类型提供 width(一次处理的实数个数)、load/store/set1 和加减乘、乘加运算
+//蝶形核函数只写一次模板，分别用标量、SSE2、AVX2实例化
+
+template<typename T>
+struct ScalarVec {
+    typedef T reg;
+    enum { width = 1 };
+    static inline reg load(const T* p) { return *p; }
+    static inline void store(T* p, reg v) { *p = v; }
+    static inline reg set1(T v) { return v; }
+    static inline reg add(reg a, reg b) { return a + b; }
+    static inline reg sub(reg a, reg b) { return a - b; }
+    static inline reg mul(reg a, reg b) { return a * b; }
+    static inline reg neg(reg a) { return -a; }
+    static inline reg fmadd(reg a, reg b, reg c) { return a * b + c; } // a*b + c
+    static inline reg fmsub(reg a, reg b, reg c) { return a * b - c; } // a*b - c
+};
+
+#ifdef FFT_HAVE_X86_SIMD
+struct SseVecD {
+    typedef __m128d reg;
+    enum { width = 2 };
+    static inline reg load(const double* p) { return _mm_loadu_pd(p); }
+    static inline void store(double* p, reg v) { _mm_storeu_pd(p, v); }
+    static inline reg set1(double v) { return _mm_set1_pd(v); }
+    static inline reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+    static inline reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+    static inline reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+    static inline reg neg(reg a) { return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+    static inline reg fmadd(reg a, reg b, reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    static inline reg fmsub(reg a, reg b, reg c) { return _mm_sub_pd(_mm_mul_pd(a, b), c); }
+};
+
+struct SseVecF {
+    typedef __m128 reg;
+    enum { width = 4 };
+    static inline reg load(const float* p) { return _mm_loadu_ps(p); }
+    static inline void store(float* p, reg v) { _mm_storeu_ps(p, v); }
+    static inline reg set1(float v) { return _mm_set1_ps(v); }
+    static inline reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+    static inline reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+    static inline reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+    static inline reg neg(reg a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    static inline reg fmadd(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static inline reg fmsub(reg a, reg b, reg c) { return _mm_sub_ps(_mm_mul_ps(a, b), c); }
+};
+
+struct AvxVecD {
+    typedef __m256d reg;
+    enum { width = 4 };
+    FFT_AVX2_TARGET static inline reg load(const double* p) { return _mm256_loadu_pd(p); }
+    FFT_AVX2_TARGET static inline void store(double* p, reg v) { _mm256_storeu_pd(p, v); }
+    FFT_AVX2_TARGET static inline reg set1(double v) { return _mm256_set1_pd(v); }
+    FFT_AVX2_TARGET static inline reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    FFT_AVX2_TARGET static inline reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+    FFT_AVX2_TARGET static inline reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+    FFT_AVX2_TARGET static inline reg neg(reg a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+    FFT_AVX2_TARGET static inline reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+    FFT_AVX2_TARGET static inline reg fmsub(reg a, reg b, reg c) { return _mm256_fmsub_pd(a, b, c); }
+};
+
+struct AvxVecF {
+    typedef __m256 reg;
+    enum { width = 8 };
+    FFT_AVX2_TARGET static inline reg load(const float* p) { return _mm256_loadu_ps(p); }
+    FFT_AVX2_TARGET static inline void store(float* p, reg v) { _mm256_storeu_ps(p, v); }
+    FFT_AVX2_TARGET static inline reg set1(float v) { return _mm256_set1_ps(v); }
+    FFT_AVX2_TARGET static inline reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    FFT_AVX2_TARGET static inline reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+    FFT_AVX2_TARGET static inline reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+    FFT_AVX2_TARGET static inline reg neg(reg a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    FFT_AVX2_TARGET static inline reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+    FFT_AVX2_TARGET static inline reg fmsub(reg a, reg b, reg c) { return _mm256_fmsub_ps(a, b, c); }
+};
+#endif
+
+//---------------- Stockham蝶形核函数 ----------------
+
+//一级Stockham变换的参数，数据为split-complex格式
+template<typename T>
+struct StageArgs {
+    int radix, m, stride;
+    const T* tw_re;
+    const T* tw_im;
+    bool invert;
+    const T* src_re;
+    const T* src_im;
+    T* dst_re;
+    T* dst_im;
+};
+
+//(re + i*im) *= (wr + i*wi)
+template<class V>
+static inline void cmul(typename V::reg& re, typename V::reg& im, const typename V::reg& wr, const typename V::reg& wi) {
+    typename V::reg r = V::fmsub(re, wr, V::mul(im, wi));
+    typename V::reg i = V::fmadd(re, wi, V::mul(im, wr));
+    re = r;
+    im = i;
+}
+
+//正变换乘 -i：(re, im) -> (im, -re)；逆变换乘 +i：(re, im) -> (-im, re)
+template<class V>
+static inline void mul_i(typename V::reg& re, typename V::reg& im, bool invert) {
+    typename V::reg r = invert ? V::neg(im) : im;
+    typename V::reg i = invert ? re : V::neg(re);
+    re = r;
+    im = i;
+}
+
+//一个radix点蝶形(一次处理V::width个相邻的q)：
+//输入 in[r*ms] (r < radix)，radix点DFT后乘旋转因子，输出 out[t*s] (t < radix)
+template<int R, typename T, class V>
+static inline void butterfly(const T* ir, const T* ii, size_t ms, T* orr, T* oi, int s,
+                             const typename V::reg* wr, const typename V::reg* wi, bool invert) {
+    typedef typename V::reg reg;
+    if (R == 2) {
+        reg a0r = V::load(ir), a0i = V::load(ii);
+        reg a1r = V::load(ir + ms), a1i = V::load(ii + ms);
+        reg b1r = V::sub(a0r, a1r), b1i = V::sub(a0i, a1i);
+        cmul<V>(b1r, b1i, wr[0], wi[0]);
+        V::store(orr, V::add(a0r, a1r)); V::store(oi, V::add(a0i, a1i));
+        V::store(orr + s, b1r); V::store(oi + s, b1i);
+    } else if (R == 3) {
+        const reg half = V::set1(T(0.5));
+        const reg sin60 = V::set1(T(0.86602540378443864676)); //sin(2*pi/3)
+        reg a0r = V::load(ir), a0i = V::load(ii);
+        reg a1r = V::load(ir + ms), a1i = V::load(ii + ms);
+        reg a2r = V::load(ir + 2 * ms), a2i = V::load(ii + 2 * ms);
+        reg sr = V::add(a1r, a2r), si = V::add(a1i, a2i);
+        reg t0r = V::sub(a0r, V::mul(half, sr)), t0i = V::sub(a0i, V::mul(half, si));
+        reg t1r = V::mul(sin60, V::sub(a1r, a2r)), t1i = V::mul(sin60, V::sub(a1i, a2i));
+        mul_i<V>(t1r, t1i, invert);
+        reg b1r = V::add(t0r, t1r), b1i = V::add(t0i, t1i);
+        reg b2r = V::sub(t0r, t1r), b2i = V::sub(t0i, t1i);
+        cmul<V>(b1r, b1i, wr[0], wi[0]);
+        cmul<V>(b2r, b2i, wr[1], wi[1]);
+        V::store(orr, V::add(a0r, sr)); V::store(oi, V::add(a0i, si));
+        V::store(orr + s, b1r); V::store(oi + s, b1i);
+        V::store(orr + 2 * s, b2r); V::store(oi + 2 * s, b2i);
+    } else if (R == 4) {
+        reg a0r = V::load(ir), a0i = V::load(ii);
+        reg a1r = V::load(ir + ms), a1i = V::load(ii + ms);
+        reg a2r = V::load(ir + 2 * ms), a2i = V::load(ii + 2 * ms);
+        reg a3r = V::load(ir + 3 * ms), a3i = V::load(ii + 3 * ms);
+        reg t0r = V::add(a0r, a2r), t0i = V::add(a0i, a2i);
+        reg t1r = V::sub(a0r, a2r), t1i = V::sub(a0i, a2i);
+        reg t2r = V::add(a1r, a3r), t2i = V::add(a1i, a3i);
+        reg t3r = V::sub(a1r, a3r), t3i = V::sub(a1i, a3i);
+        mul_i<V>(t3r, t3i, invert);
+        reg b1r = V::add(t1r, t3r), b1i = V::add(t1i, t3i);
+        reg b2r = V::sub(t0r, t2r), b2i = V::sub(t0i, t2i);
+        reg b3r = V::sub(t1r, t3r), b3i = V::sub(t1i, t3i);
+        cmul<V>(b1r, b1i, wr[0], wi[0]);
+        cmul<V>(b2r, b2i, wr[1], wi[1]);
+        cmul<V>(b3r, b3i, wr[2], wi[2]);
+        V::store(orr, V::add(t0r, t2r)); V::store(oi, V::add(t0i, t2i));
+        V::store(orr + s, b1r); V::store(oi + s, b1i);
+        V::store(orr + 2 * s, b2r); V::store(oi + 2 * s, b2i);
+        V::store(orr + 3 * s, b3r); V::store(oi + 3 * s, b3i);
+    } else {
+        const reg c1 = V::set1(T(0.30901699437494742410));  //cos(2*pi/5)
+        const reg c2 = V::set1(T(-0.80901699437494742410)); //cos(4*pi/5)
+        const reg s1 = V::set1(T(0.95105651629515357212));  //sin(2*pi/5)
+        const reg s2 = V::set1(T(0.58778525229247312917));  //sin(4*pi/5)
+        reg a0r = V::load(ir), a0i = V::load(ii);
+        reg a1r = V::load(ir + ms), a1i = V::load(ii + ms);
+        reg a2r = V::load(ir + 2 * ms), a2i = V::load(ii + 2 * ms);
+        reg a3r = V::load(ir + 3 * ms), a3i = V::load(ii + 3 * ms);
+        reg a4r = V::load(ir + 4 * ms), a4i = V::load(ii + 4 * ms);
+        reg t1r = V::add(a1r, a4r), t1i = V::add(a1i, a4i);
+        reg t2r = V::add(a2r, a3r), t2i = V::add(a2i, a3i);
+        reg t3r = V::sub(a1r, a4r), t3i = V::sub(a1i, a4i);
+        reg t4r = V::sub(a2r, a3r), t4i = V::sub(a2i, a3i);
+        reg r1r = V::fmadd(c2, t2r, V::fmadd(c1, t1r, a0r)), r1i = V::fmadd(c2, t2i, V::fmadd(c1, t1i, a0i));
+        reg r2r = V::fmadd(c1, t2r, V::fmadd(c2, t1r, a0r)), r2i = V::fmadd(c1, t2i, V::fmadd(c2, t1i, a0i));
+        reg i1r = V::fmadd(s2, t4r, V::mul(s1, t3r)), i1i = V::fmadd(s2, t4i, V::mul(s1, t3i));
+        reg i2r = V::fmsub(s2, t3r, V::mul(s1, t4r)), i2i = V::fmsub(s2, t3i, V::mul(s1, t4i));
+        mul_i<V>(i1r, i1i, invert);
+        mul_i<V>(i2r, i2i, invert);
+        reg b1r = V::add(r1r, i1r), b1i = V::add(r1i, i1i);
+        reg b2r = V::add(r2r, i2r), b2i = V::add(r2i, i2i);
+        reg b3r = V::sub(r2r, i2r), b3i = V::sub(r2i, i2i);
+        reg b4r = V::sub(r1r, i1r), b4i = V::sub(r1i, i1i);
+        cmul<V>(b1r, b1i, wr[0], wi[0]);
+        cmul<V>(b2r, b2i, wr[1], wi[1]);
+        cmul<V>(b3r, b3i, wr[2], wi[2]);
+        cmul<V>(b4r, b4i, wr[3], wi[3]);
+        V::store(orr, V::add(a0r, V::add(t1r, t2r))); V::store(oi, V::add(a0i, V::add(t1i, t2i)));
+        V::store(orr + s, b1r); V::store(oi + s, b1i);
+        V::store(orr + 2 * s, b2r); V::store(oi + 2 * s, b2i);
+        V::store(orr + 3 * s, b3r); V::store(oi + 3 * s, b3i);
+        V::store(orr + 4 * s, b4r); V::store(oi + 4 * s, b4i);
+    }
+}
+
+//一级Stockham变换：第k组的输入 src[q + s*(k + r*m)]，输出 dst[q + s*(radix*k + t)]
+//同一组k内相邻的q(共stride个)使用同一组旋转因子，按向量宽度成批处理
+//stride小于向量宽度的前几级以及余下的列用标量版本
+template<int R, typename T, class V>
+static void run_stage_radix(const StageArgs<T>& a) {
+    typedef ScalarVec<T> S;
+    const int s = a.stride;
+    const size_t ms = (size_t)s * a.m;
+    for (int k = 0; k < a.m; k++) {
+        typename S::reg wr_s[4], wi_s[4];
+        typename V::reg wr_v[4], wi_v[4];
+        for (int t = 0; t < R - 1; t++) {
+            wr_s[t] = a.tw_re[k * (R - 1) + t];
+            wi_s[t] = a.invert ? -a.tw_im[k * (R - 1) + t] : a.tw_im[k * (R - 1) + t];
+            wr_v[t] = V::set1(wr_s[t]);
+            wi_v[t] = V::set1(wi_s[t]);
+        }
+        const T* ir = a.src_re + (size_t)s * k;
+        const T* ii = a.src_im + (size_t)s * k;
+        T* orr = a.dst_re + (size_t)s * R * k;
+        T* oi = a.dst_im + (size_t)s * R * k;
+        int q = 0;
+        if (V::width > 1) {
+            for (; q + (int)V::width <= s; q += V::width) {
+                butterfly<R, T, V>(ir + q, ii + q, ms, orr + q, oi + q, s, wr_v, wi_v, a.invert);
+            }
+        }
+        for (; q < s; q++) {
+            butterfly<R, T, S>(ir + q, ii + q, ms, orr + q, oi + q, s, wr_s, wi_s, a.invert);
+        }
+    }
+}
+
+template<typename T, class V>
+static void run_stage(const StageArgs<T>& a) {
+    switch (a.radix) {
+    case 2: run_stage_radix<2, T, V>(a); break;
+    case 3: run_stage_radix<3, T, V>(a); break;
+    case 4: run_stage_radix<4, T, V>(a); break;
+    case 5: run_stage_radix<5, T, V>(a); break;
+    }
+}
+
+static void run_stage_scalar(const StageArgs<double>& a) { run_stage<double, ScalarVec<double>>(a); }
+static void run_stage_scalar(const StageArgs<float>& a) { run_stage<float, ScalarVec<float>>(a); }
+#ifdef FFT_HAVE_X86_SIMD
+static void run_stage_sse2(const StageArgs<double>& a) { run_stage<double, SseVecD>(a); }
+static void run_stage_sse2(const StageArgs<float>& a) { run_stage<float, SseVecF>(a); }
+FFT_AVX2_ENTRY static void run_stage_avx2(const StageArgs<double>& a) { run_stage<double, AvxVecD>(a); }
+FFT_AVX2_ENTRY static void run_stage_avx2(const StageArgs<float>& a) { run_stage<float, AvxVecF>(a); }
+#endif
+
+template<typename T>
+static void run_stage_dispatch(const StageArgs<T>& a, FFTSimdLevel level) {
+#ifdef FFT_HAVE_X86_SIMD
+    //stride不足一个AVX向量的前几级改用SSE2，仍能向量化
+    if (level == FFT_SIMD_AVX2 && a.stride >= 32 / (int)sizeof(T)) { run_stage_avx2(a); return; }
+    if (level >= FFT_SIMD_SSE2) { run_stage_sse2(a); return; }
+#endif
+    run_stage_scalar(a);
+}
+
+//---------------- FFTPlan1D_ ----------------
+
+template<typename T>
+FFTPlan1D_<T>::FFTPlan1D_(int n) : n_(n) {
+    if (n_ <= 1) return;
+
+    //分解n：优先用基4，其次基2、3、5
+    vector<int> radices;
+    int rest = n_;
+    while (rest % 4 == 0) { radices.push_back(4); rest /= 4; }
+    while (rest % 2 == 0) { radices.push_back(2); rest /= 2; }
+    while (rest % 3 == 0) { radices.push_back(3); rest /= 3; }
+    while (rest % 5 == 0) { radices.push_back(5); rest /= 5; }
+
+    if (rest != 1) {
+        //含有大于5的素因子：Bluestein算法
+        //X[k] = chirp[k] * sum_j (x[j]*chirp[j]) * conj(chirp[k-j])，其中 chirp[k] = exp(-pi*i*k^2/n)
+        int conv_n = 1;
+        while (conv_n < 2 * n_ - 1) conv_n <<= 1;
+        conv_plan_ = make_shared<FFTPlan1D_<T>>(conv_n);
+
+        chirp_.resize(n_);
+        for (int k = 0; k < n_; k++) {
+            //k^2对2n取模后再算角度，避免k很大时的精度损失
+            long long k2 = (long long)k * k % (2LL * n_);
+            double angle = -CV_PI * k2 / n_;
+            chirp_[k] = complex<T>((T)cos(angle), (T)sin(angle));
+        }
+        chirp_fft_.assign(conv_n, complex<T>(0, 0));
+        chirp_fft_[0] = conj(chirp_[0]);
+        for (int k = 1; k < n_; k++) {
+            chirp_fft_[k] = conj(chirp_[k]);
+            chirp_fft_[conv_n - k] = conj(chirp_[k]);
+        }
+        conv_plan_->execute(chirp_fft_.data(), false);
+        for (auto& v : chirp_fft_) v /= (T)conv_n;
+        return;
+    }
+
+    //Stockham各级：本级长度len = radix * m，旋转因子 W_len^(k*t), k < m, 1 <= t < radix
+    int len = n_;
+    int stride = 1;
+    for (int radix : radices) {
+        Stage stage;
+        stage.radix = radix;
+        stage.m = len / radix;
+        stage.stride = stride;
+        stage.twiddle_pos = twiddle_re_.size();
+        for (int k = 0; k < stage.m; k++) {
+            for (int t = 1; t < radix; t++) {
+                double angle = -2 * CV_PI * k * t / len;
+                twiddle_re_.push_back((T)cos(angle));
+                twiddle_im_.push_back((T)sin(angle));
+            }
+        }
+        stages_.push_back(stage);
+        len = stage.m;
+        stride *= radix;
+    }
+}
+
+//按Stockham算法逐级变换：(re, im) 中按 x[k*lanes + b] 存放lanes个交错的信号
+//lanes个信号共用旋转因子，等价于把每一级的stride放大lanes倍，因此批量变换不需要另写蝶形核函数
+//各级在 (re, im) 与 (tmp_re, tmp_im) 之间交替读写，返回后 (re, im) 指向结果
+template<typename T>
+void FFTPlan1D_<T>::run_stages(T*& re, T*& im, T*& tmp_re, T*& tmp_im, int lanes, bool invert) const {
+    const FFTSimdLevel level = fft_simd_level();
+    for (const Stage& stage : stages_) {
+        StageArgs<T> args;
+        args.radix = stage.radix;
+        args.m = stage.m;
+        args.stride = stage.stride * lanes;
+        args.tw_re = twiddle_re_.data() + stage.twiddle_pos;
+        args.tw_im = twiddle_im_.data() + stage.twiddle_pos;
+        args.invert = invert;
+        args.src_re = re;
+        args.src_im = im;
+        args.dst_re = tmp_re;
+        args.dst_im = tmp_im;
+        run_stage_dispatch(args, level);
+        swap(re, tmp_re);
+        swap(im, tmp_im);
+    }
+}
+
+//Stockham自排序FFT：数据拆成实部、虚部两个数组，每一级从src读、向dst写，两组缓冲区交替使用
+//最后合并回交错存放的复数，逆变换的1/n缩放也在这一步完成
+//lanes > 1时data按 data[k*lanes + b] 存放lanes个信号 (行优先矩阵的各列)，拆分时顺序不变
+template<typename T>
+void FFTPlan1D_<T>::stockham(complex<T>* data, int lanes, bool invert) const {
+    size_t total = (size_t)n_ * lanes;
+    static thread_local vector<T> work;
+    if (work.size() < 4 * total) work.resize(4 * total);
+    T* src_re = work.data();
+    T* src_im = src_re + total;
+    T* dst_re = src_im + total;
+    T* dst_im = dst_re + total;
+
+    const T* in = reinterpret_cast<const T*>(data);
+    for (size_t i = 0; i < total; i++) {
+        src_re[i] = in[2 * i];
+        src_im[i] = in[2 * i + 1];
+    }
+
+    run_stages(src_re, src_im, dst_re, dst_im, lanes, invert);
+
+    T scale = invert ? T(1) / n_ : T(1);
+    T* out = reinterpret_cast<T*>(data);
+    for (size_t i = 0; i < total; i++) {
+        out[2 * i] = src_re[i] * scale;
+        out[2 * i + 1] = src_im[i] * scale;
+    }
+}
+
+//Bluestein：逆变换利用 IDFT(x) = conj(DFT(conj(x))) / n
+template<typename T>
+void FFTPlan1D_<T>::bluestein(complex<T>* data, bool invert) const {
+    int conv_n = conv_plan_->size();
+    static thread_local vector<complex<T>> conv;
+    conv.assign(conv_n, complex<T>(0, 0));
+    for (int k = 0; k < n_; k++) {
+        complex<T> x = invert ? conj(data[k]) : data[k];
+        conv[k] = x * chirp_[k];
+    }
+    conv_plan_->execute(conv.data(), false);
+    for (int k = 0; k < conv_n; k++) conv[k] *= chirp_fft_[k];
+    //chirp_fft_已经除以conv_n，这里用不缩放的逆变换：对共轭做正变换再取共轭
+    for (int k = 0; k < conv_n; k++) conv[k] = conj(conv[k]);
+    conv_plan_->execute(conv.data(), false);
+    T scale = invert ? T(1) / n_ : T(1);
+    for (int k = 0; k < n_; k++) {
+        complex<T> y = conj(conv[k]) * chirp_[k];
+        data[k] = (invert ? conj(y) : y) * scale;
+    }
+}
+
+//一维快速傅里叶变换 (FFT)
+template<typename T>
+void FFTPlan1D_<T>::execute(complex<T>* data, bool invert) const {
+    if (n_ <= 1) return;
+    if (conv_plan_) {
+        bluestein(data, invert);
+    } else {
+        stockham(data, 1, invert);
+    }
+}
+
+template<typename T>
+void FFTPlan1D_<T>::execute_strided(complex<T>* data, int lanes, bool invert) const {
+    if (n_ <= 1 || lanes <= 0) return;
+    if (!conv_plan_) {
+        stockham(data, lanes, invert);
+        return;
+    }
+    //Bluestein长度逐个信号取出来变换
+    static thread_local vector<complex<T>> lane;
+    lane.resize(n_);
+    for (int b = 0; b < lanes; b++) {
+        for (int k = 0; k < n_; k++) lane[k] = data[(size_t)k * lanes + b];
+        bluestein(lane.data(), invert);
+        for (int k = 0; k < n_; k++) data[(size_t)k * lanes + b] = lane[k];
+    }
+}
+
+//每组交错的信号个数：8~16个，使AVX的各通道都用上；4份工作数组合计不超过约256KB，留在L2缓存中
+//组再大时转置的跨度变大，实测反而变慢
+static int batch_group_lanes(int n, size_t elem_size) {
+    size_t budget = 256 * 1024 / (4 * elem_size * (size_t)n);
+    int lanes = (int)min<size_t>(max<size_t>(budget, 8), 16);
+    return lanes & ~7;
+}
+
+//连续存放的batch个信号：每次取一组，转置成 x[k*lanes + b] 后一起变换，再转置回去
+//各组交给fft_num_threads()个线程
+template<typename T>
+void FFTPlan1D_<T>::execute_batch(complex<T>* data, int batch, bool invert) const {
+    if (n_ <= 1 || batch <= 0) return;
+    if (conv_plan_ || batch == 1) {
+        fft_parallel(batch, [&](int begin, int end) {
+            for (int b = begin; b < end; b++) execute(data + (size_t)b * n_, invert);
+        });
+        return;
+    }
+    int group = batch_group_lanes(n_, sizeof(T));
+    int groups = (batch + group - 1) / group;
+    fft_parallel(groups, [&](int g_begin, int g_end) {
+        static thread_local vector<T> work;
+        size_t total = (size_t)n_ * group;
+        if (work.size() < 4 * total) work.resize(4 * total);
+        for (int g = g_begin; g < g_end; g++) {
+            int b0 = g * group;
+            int lanes = min(group, batch - b0);
+            size_t count = (size_t)n_ * lanes;
+            T* re = work.data();
+            T* im = re + count;
+            T* tmp_re = im + count;
+            T* tmp_im = tmp_re + count;
+            //按8个信号一组转置：每次从8个信号各读一段连续数据，写入交错格式的连续位置
+            for (int bb = 0; bb < lanes; bb += 8) {
+                int width = min(8, lanes - bb);
+                const complex<T>* src = data + (size_t)(b0 + bb) * n_;
+                for (int k = 0; k < n_; k++) {
+                    T* r = re + (size_t)k * lanes + bb;
+                    T* m = im + (size_t)k * lanes + bb;
+                    for (int b = 0; b < width; b++) {
+                        r[b] = src[(size_t)b * n_ + k].real();
+                        m[b] = src[(size_t)b * n_ + k].imag();
+                    }
+                }
+            }
+            run_stages(re, im, tmp_re, tmp_im, lanes, invert);
+            T scale = invert ? T(1) / n_ : T(1);
+            for (int bb = 0; bb < lanes; bb += 8) {
+                int width = min(8, lanes - bb);
+                complex<T>* dst = data + (size_t)(b0 + bb) * n_;
+                for (int k = 0; k < n_; k++) {
+                    const T* r = re + (size_t)k * lanes + bb;
+                    const T* m = im + (size_t)k * lanes + bb;
+                    for (int b = 0; b < width; b++) {
+                        dst[(size_t)b * n_ + k] = complex<T>(r[b] * scale, m[b] * scale);
+                    }
+                }
+            }
+        }
+    });
+}
+
+//---------------- FFTPlan2D_ ----------------
+
+template<typename T>
+FFTPlan2D_<T>::FFTPlan2D_(int rows, int cols)
+    : rows_(rows), cols_(cols), row_plan_(cols), col_plan_(rows) {
+    buffer_ = static_cast<complex<T>*>(fastMalloc(sizeof(complex<T>) * rows_ * cols_));
+}
+
+template<typename T>
+FFTPlan2D_<T>::~FFTPlan2D_() {
+    fastFree(buffer_);
+}
+
+template<typename T>
+bool FFTPlan2D_<T>::load(const Mat& img_gray) {
+    if (img_gray.type() != CV_8UC1 || img_gray.rows > rows_ || img_gray.cols > cols_) {
+        cerr << "错误: 输入图像必须是8位单通道灰度图，且尺寸不超过FFT计划 "
+             << cols_ << "x" << rows_ << endl;
+        return false;
+    }
+    for (int i = 0; i < img_gray.rows; ++i) {
+        const uchar* src = img_gray.ptr<uchar>(i);
+        complex<T>* dst = row(i);
+        for (int j = 0; j < img_gray.cols; ++j) dst[j] = complex<T>(src[j], 0);
+        fill(dst + img_gray.cols, dst + cols_, complex<T>(0, 0));
+    }
+    fill(row(img_gray.rows), buffer_ + (size_t)rows_ * cols_, complex<T>(0, 0));
+    return true;
+}
+
+//列变换：每行一次读写FFT_COL_TILE个相邻元素，访存是顺序的
+//每个线程处理连续的若干组列，使用自己的分块缓冲区
+//mask为空时按invert做一次变换；否则每组列依次做正变换、乘模板 mask[i * mask_stride + c]、逆变换
+template<typename T>
+static void columns_pass(complex<T>* data, int rows, int cols, size_t stride,
+                         const FFTPlan1D_<T>& plan, bool invert, const T* mask, size_t mask_stride) {
+    int groups = (cols + FFT_COL_TILE - 1) / FFT_COL_TILE;
+    fft_parallel(groups, [&](int g_begin, int g_end) {
+        static thread_local vector<complex<T>> tile_buf;
+        if (tile_buf.size() < (size_t)rows * FFT_COL_TILE) tile_buf.resize((size_t)rows * FFT_COL_TILE);
+        complex<T>* tile = tile_buf.data();
+        for (int g = g_begin; g < g_end; ++g) {
+            int c0 = g * FFT_COL_TILE;
+            int width = min(FFT_COL_TILE, cols - c0);
+            for (int i = 0; i < rows; ++i) {
+                const complex<T>* src = data + i * stride + c0;
+                for (int b = 0; b < width; ++b) tile[b * rows + i] = src[b];
+            }
+            if (mask) {
+                for (int b = 0; b < width; ++b) plan.execute(tile + b * rows, false);
+                for (int i = 0; i < rows; ++i) {
+                    const T* m = mask + i * mask_stride + c0;
+                    for (int b = 0; b < width; ++b) tile[b * rows + i] *= m[b];
+                }
+                for (int b = 0; b < width; ++b) plan.execute(tile + b * rows, true);
+            } else {
+                for (int b = 0; b < width; ++b) plan.execute(tile + b * rows, invert);
+            }
+            for (int i = 0; i < rows; ++i) {
+                complex<T>* dst = data + i * stride + c0;
+                for (int b = 0; b < width; ++b) dst[b] = tile[b * rows + i];
+            }
+        }
+    });
+}
+
+template<typename T>
+void fft_columns(complex<T>* data, int rows, int cols, size_t stride,
+                 const FFTPlan1D_<T>& plan, bool invert) {
+    columns_pass(data, rows, cols, stride, plan, invert, static_cast<const T*>(nullptr), 0);
+}
+
+//二维快速傅里叶变换 (2D FFT)：先对每一行，再对每一列做1D FFT
+template<typename T>
+void FFTPlan2D_<T>::forward() {
+    fft_parallel(rows_, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) row_plan_.execute(row(i), false);
+    });
+    fft_columns(buffer_, rows_, cols_, cols_, col_plan_, false);
+}
+
+template<typename T>
+void FFTPlan2D_<T>::inverse() {
+    fft_parallel(rows_, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) row_plan_.execute(row(i), true);
+    });
+    fft_columns(buffer_, rows_, cols_, cols_, col_plan_, true);
+}
+
+template<typename T>
+void FFTPlan2D_<T>::fftshift() {
+    int cy = rows_ / 2;
+    int cx = cols_ / 2;
+    for (int y = 0; y < cy; ++y) {
+        complex<T>* top = row(y);
+        complex<T>* bottom = row(y + cy);
+        for (int x = 0; x < cx; ++x) {
+            //交换第一和第四象限
+            swap(top[x], bottom[x + cx]);
+            //交换第二和第三象限
+            swap(top[x + cx], bottom[x]);
+        }
+    }
+}
+
+//---------------- FFTBatchPlan2D_ ----------------
+
+template<typename T>
+FFTBatchPlan2D_<T>::FFTBatchPlan2D_(int rows, int cols)
+    : rows_(rows), cols_(cols), row_plan_(cols), col_plan_(rows) {
+}
+
+//所有块的所有行作为 batch*rows 个信号批量变换；每块的各列本来就是 x[k*cols + c] 的交错格式
+template<typename T>
+void FFTBatchPlan2D_<T>::execute(complex<T>* data, int batch, bool invert) const {
+    if (batch <= 0) return;
+    row_plan_.execute_batch(data, batch * rows_, invert);
+    size_t block = (size_t)rows_ * cols_;
+    fft_parallel(batch, [&](int begin, int end) {
+        for (int b = begin; b < end; b++) col_plan_.execute_strided(data + b * block, cols_, invert);
+    });
+}
+
+//---------------- RealFFTPlan2D_ ----------------
+
+template<typename T>
+RealFFTPlan2D_<T>::RealFFTPlan2D_(int rows, int cols)
+    : rows_(rows), cols_(cols), spec_cols_(cols / 2 + 1),
+      row_plan_(cols % 2 == 0 ? cols / 2 : cols), col_plan_(rows) {
+    buffer_ = static_cast<complex<T>*>(fastMalloc(sizeof(complex<T>) * rows_ * spec_cols_));
+    if (cols_ % 2 == 0) {
+        split_twiddle_.resize(cols_ / 2);
+        for (int k = 0; k < cols_ / 2; k++) {
+            double angle = -2 * CV_PI * k / cols_;
+            split_twiddle_[k] = complex<T>((T)cos(angle), (T)sin(angle));
+        }
+    }
+}
+
+template<typename T>
+RealFFTPlan2D_<T>::~RealFFTPlan2D_() {
+    fastFree(buffer_);
+}
+
+//cols_为奇数时行变换退化为完整复数FFT，所用的线程局部缓冲区
+template<typename T>
+static complex<T>* odd_row_scratch(int cols) {
+    static thread_local vector<complex<T>> scratch;
+    if (scratch.size() < (size_t)cols) scratch.resize(cols);
+    return scratch.data();
+}
+
+template<typename T>
+bool RealFFTPlan2D_<T>::load(const Mat& img_gray) {
+    if (img_gray.type() != CV_8UC1 || img_gray.rows > rows_ || img_gray.cols > cols_) {
+        cerr << "错误: 输入图像必须是8位单通道灰度图，且尺寸不超过FFT计划 "
+             << cols_ << "x" << rows_ << endl;
+        return false;
+    }
+    for (int i = 0; i < img_gray.rows; ++i) {
+        const uchar* src = img_gray.ptr<uchar>(i);
+        T* dst = real_row(i);
+        for (int j = 0; j < img_gray.cols; ++j) dst[j] = src[j];
+        fill(dst + img_gray.cols, dst + cols_, T(0));
+    }
+    fill(spectrum_row(img_gray.rows), buffer_ + (size_t)rows_ * spec_cols_, complex<T>(0, 0));
+    return true;
+}
+
+//一行实数 -> 半频谱 (原地)
+//偶数长度N：z[k] = x[2k] + i*x[2k+1] 做N/2点FFT得到Z，再按
+//X[k] = (Z[k] + conj(Z[N/2-k]))/2 + W^k * (Z[k] - conj(Z[N/2-k]))/(2i) 拆分
+template<typename T>
+void RealFFTPlan2D_<T>::r2c_row(complex<T>* data) const {
+    if (cols_ % 2 != 0) {
+        complex<T>* scratch = odd_row_scratch<T>(cols_);
+        const T* x = reinterpret_cast<const T*>(data);
+        for (int j = 0; j < cols_; ++j) scratch[j] = complex<T>(x[j], 0);
+        row_plan_.execute(scratch, false);
+        copy(scratch, scratch + spec_cols_, data);
+        return;
+    }
+
+    int m = cols_ / 2;
+    row_plan_.execute(data, false);
+
+    complex<T> z0 = data[0];
+    data[0] = complex<T>(z0.real() + z0.imag(), 0);
+    data[m] = complex<T>(z0.real() - z0.imag(), 0);
+    //X[k] 与 X[m-k] 由同一对 Z[k]、Z[m-k] 得到，成对原地计算
+    for (int k = 1; k <= m / 2; ++k) {
+        complex<T> a = data[k];
+        complex<T> b = conj(data[m - k]);
+        complex<T> even = (a + b) * T(0.5);
+        complex<T> odd = (a - b) * complex<T>(0, T(-0.5));
+        complex<T> t = split_twiddle_[k] * odd;
+        data[k] = even + t;
+        data[m - k] = conj(even - t);
+    }
+}
+
+//半频谱 -> 一行实数 (原地)，是r2c_row的逆过程，结果除以cols_
+template<typename T>
+void RealFFTPlan2D_<T>::c2r_row(complex<T>* data) const {
+    if (cols_ % 2 != 0) {
+        //按共轭对称补全另一半频谱，再做完整的复数逆变换
+        complex<T>* scratch = odd_row_scratch<T>(cols_);
+        copy(data, data + spec_cols_, scratch);
+        for (int k = spec_cols_; k < cols_; ++k) scratch[k] = conj(scratch[cols_ - k]);
+        row_plan_.execute(scratch, true);
+        T* x = reinterpret_cast<T*>(data);
+        for (int j = 0; j < cols_; ++j) x[j] = scratch[j].real();
+        return;
+    }
+
+    int m = cols_ / 2;
+    complex<T> x0 = data[0];
+    complex<T> xm = data[m];
+    data[0] = complex<T>((x0.real() + xm.real()) * T(0.5), (x0.real() - xm.real()) * T(0.5));
+    for (int k = 1; k <= m / 2; ++k) {
+        complex<T> a = data[k];
+        complex<T> b = conj(data[m - k]);
+        complex<T> even = (a + b) * T(0.5);
+        complex<T> odd = (a - b) * T(0.5) * conj(split_twiddle_[k]);
+        complex<T> i_odd(-odd.imag(), odd.real());
+        data[k] = even + i_odd;
+        data[m - k] = conj(even) + complex<T>(odd.imag(), odd.real());
+    }
+    //N/2点逆变换除以N/2，而实数结果需要除以N，正好由上面的0.5补齐
+    row_plan_.execute(data, true);
+}
+
+//先对每一行做R2C，再对 cols/2+1 列做复数FFT
+template<typename T>
+void RealFFTPlan2D_<T>::forward() {
+    fft_parallel(rows_, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) r2c_row(spectrum_row(i));
+    });
+    fft_columns(buffer_, rows_, spec_cols_, spec_cols_, col_plan_, false);
+}
+
+template<typename T>
+void RealFFTPlan2D_<T>::inverse() {
+    fft_columns(buffer_, rows_, spec_cols_, spec_cols_, col_plan_, true);
+    fft_parallel(rows_, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) c2r_row(spectrum_row(i));
+    });
+}
+
+//行R2C、列方向(正变换、乘模板、逆变换)、行C2R三遍完成整个滤波
+template<typename T>
+void RealFFTPlan2D_<T>::filter(const T* mask, const RowCallback& fill_row, const RowCallback& row_done) {
+    fft_parallel(rows_, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            if (fill_row) fill_row(i, real_row(i));
+            r2c_row(spectrum_row(i));
+        }
+    });
+    columns_pass(buffer_, rows_, spec_cols_, spec_cols_, col_plan_, false, mask, spec_cols_);
+    fft_parallel(rows_, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            c2r_row(spectrum_row(i));
+            if (row_done) row_done(i, real_row(i));
+        }
+    });
+}
+
+//显式实例化float和double两种精度
+template class FFTPlan1D_<float>;
+template class FFTPlan1D_<double>;
+template class FFTPlan2D_<float>;
+template class FFTPlan2D_<double>;
+template class FFTBatchPlan2D_<float>;
+template class FFTBatchPlan2D_<double>;
+template class RealFFTPlan2D_<float>;
+template class RealFFTPlan2D_<double>;
+template void fft_columns<float>(complex<float>*, int, int, size_t, const FFTPlan1D_<float>&, bool);
+template void fft_columns<double>(complex<double>*, int, int, size_t, const FFTPlan1D_<double>&, bool);
@@ -0,0 +1,192 @@
+// fft_plan.h
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <memory>
+#include <functional>
+#include <opencv2/opencv.hpp>
+
+//FFT蝶形运算使用的指令集，运行时按CPU支持情况自动选择
+enum FFTSimdLevel {
+    FFT_SIMD_SCALAR = 0,
+    FFT_SIMD_SSE2 = 1,
+    FFT_SIMD_AVX2 = 2
+};
+//当前实际使用的指令集
+FFTSimdLevel fft_simd_level();
+//限制可使用的最高指令集(用于和标量路径对比测速)，实际取它与CPU支持情况中较低的一个
+void fft_set_simd_level(FFTSimdLevel level);
+
+//二维FFT行、列变换使用的线程数：各行(各列)互相独立，用cv::parallel_for_分成n段并行计算
+//n <= 0 (默认)表示使用cv::getNumThreads()，n == 1 为单线程；实际并发数不超过OpenCV线程池的大小
+//每一行、每一列的计算与分段方式无关，因此结果与线程数无关，逐位一致
+int fft_num_threads();
+void fft_set_num_threads(int n);
+
+//一维FFT计划：对固定长度n，只计算一次分解方式和各级旋转因子表
+//n分解为4、2、3、5的乘积时按Stockham自排序算法逐级做混合基蝶形运算(不需要位反转置换)
+//含其他素因子(如素数长度)时用Bluestein算法：把DFT改写成卷积，借助2的幂次长度的FFT计算
+//因此getOptimalDFTSize给出的任意尺寸都能直接变换，不必再补到2的幂次
+//T为float或double：显示用的滤波结果不需要双精度，float版本的吞吐量约为两倍
+//变换时先把数据拆成实部、虚部两个数组(split-complex)，蝶形运算用SSE2/AVX2一次处理多个复数
+template<typename T>
+class FFTPlan1D_ {
+public:
+    explicit FFTPlan1D_(int n = 0);
+
+    int size() const { return n_; }
+    //对连续存放的n个复数做原地变换，invert为true时做逆变换(结果除以n)
+    //工作缓冲区是线程局部的，同一个计划可以被多个线程同时使用
+    void execute(std::complex<T>* data, bool invert) const;
+    //批量变换：data中连续存放batch个长度为n的信号(第b个从data + b*n开始)，逐个原地变换
+    //内部每次把若干个信号转置成 x[k*lanes + b] 的交错格式一起变换，SIMD的各个通道对应不同的信号，
+    //即使n很小也能整级向量化；各组信号分给fft_num_threads()个线程
+    void execute_batch(std::complex<T>* data, int batch, bool invert) const;
+    //对已经交错存放的lanes个信号原地变换：第b个信号的第k个元素为 data[k*lanes + b]
+    //即按行存放的 n x lanes 矩阵的各列，不需要转置
+    void execute_strided(std::complex<T>* data, int lanes, bool invert) const;
+
+private:
+    struct Stage {
+        int radix;          //本级的基：2、3、4、5
+        int m;              //本级每组的蝶形个数 (本级长度 / radix)
+        int stride;         //已完成各级基的乘积
+        size_t twiddle_pos; //本级旋转因子在twiddle_re_/twiddle_im_中的起始位置，共 m * (radix-1) 个
+    };
+    void run_stages(T*& re, T*& im, T*& tmp_re, T*& tmp_im, int lanes, bool invert) const;
+    void stockham(std::complex<T>* data, int lanes, bool invert) const;
+    void bluestein(std::complex<T>* data, bool invert) const;
+
+    int n_;
+    std::vector<Stage> stages_;
+    std::vector<T> twiddle_re_;  //正变换的旋转因子(实部、虚部分开存放)，逆变换时取共轭
+    std::vector<T> twiddle_im_;
+
+    //Bluestein：长度为 conv_n >= 2n-1 的2的幂次卷积
+    std::shared_ptr<FFTPlan1D_<T>> conv_plan_;
+    std::vector<std::complex<T>> chirp_;      //exp(-pi*i*k^2/n), k < n
+    std::vector<std::complex<T>> chirp_fft_;  //卷积核 conj(chirp) 的FFT，已除以conv_n
+};
+
+typedef FFTPlan1D_<double> FFTPlan1D;
+typedef FFTPlan1D_<float> FFTPlan1Df;
+
+//二维FFT计划：持有一块连续、64字节对齐的复数缓冲区(按行存放rows x cols)
+//行变换直接在缓冲区上进行；列变换按FFT_COL_TILE列为一组拷入小块缓冲区做，避免整幅转置
+//行、列变换按fft_num_threads()多线程进行
+//同一尺寸的多次滤波(如视频逐帧处理)复用同一个计划，不再每次调用都分配内存
+template<typename T>
+class FFTPlan2D_ {
+public:
+    FFTPlan2D_(int rows, int cols);
+    ~FFTPlan2D_();
+    FFTPlan2D_(const FFTPlan2D_&) = delete;
+    FFTPlan2D_& operator=(const FFTPlan2D_&) = delete;
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    std::complex<T>* data() { return buffer_; }
+    std::complex<T>* row(int i) { return buffer_ + (size_t)i * cols_; }
+    const std::complex<T>* row(int i) const { return buffer_ + (size_t)i * cols_; }
+
+    //将8位单通道图像拷入缓冲区左上角，其余位置补零(代替copyMakeBorder)
+    bool load(const cv::Mat& img_gray);
+    void forward();
+    void inverse();
+    //将频谱的四个象限进行对角交换
+    void fftshift();
+
+private:
+    int rows_;
+    int cols_;
+    std::complex<T>* buffer_; //rows_ * cols_
+    FFTPlan1D_<T> row_plan_;
+    FFTPlan1D_<T> col_plan_;
+};
+
+typedef FFTPlan2D_<double> FFTPlan2D;
+typedef FFTPlan2D_<float> FFTPlan2Df;
+
+//批量二维FFT：对连续存放的batch个 rows x cols 复数块(如纹理分析的小窗口)逐个原地变换
+//行变换是 batch*rows 个信号的批量变换，列变换直接在每块上按交错格式进行
+//计划本身不持有缓冲区，可以被多个线程同时使用
+template<typename T>
+class FFTBatchPlan2D_ {
+public:
+    FFTBatchPlan2D_(int rows, int cols);
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    //第b块从 data + b*rows*cols 开始，按行存放
+    void execute(std::complex<T>* data, int batch, bool invert) const;
+
+private:
+    int rows_;
+    int cols_;
+    FFTPlan1D_<T> row_plan_;
+    FFTPlan1D_<T> col_plan_;
+};
+
+typedef FFTBatchPlan2D_<double> FFTBatchPlan2D;
+typedef FFTBatchPlan2D_<float> FFTBatchPlan2Df;
+
+//对按行存放(行跨度为stride个复数)的rows x cols矩阵做列方向的1D FFT
+//每次取FFT_COL_TILE列拷入线程局部的分块缓冲区(每列连续)，变换后写回，不需要整幅转置
+//各组列分给fft_num_threads()个线程
+const int FFT_COL_TILE = 8; //8个complex<double>正好两条缓存行
+template<typename T>
+void fft_columns(std::complex<T>* data, int rows, int cols, size_t stride,
+                 const FFTPlan1D_<T>& plan, bool invert);
+
+//实数输入的二维FFT计划 (R2C / C2R)
+//实数图像的频谱满足共轭对称 F(-u,-v) = conj(F(u,v))，只需保存每行前 cols/2+1 个频点
+//行变换把相邻两个实数打包成一个复数，做 cols/2 点复数FFT后再拆分，计算量和内存都约为复数版的一半
+//缓冲区按行存放 rows x (cols/2+1) 个复数；逆变换后同一块内存按行存放实数结果
+template<typename T>
+class RealFFTPlan2D_ {
+public:
+    RealFFTPlan2D_(int rows, int cols);
+    ~RealFFTPlan2D_();
+    RealFFTPlan2D_(const RealFFTPlan2D_&) = delete;
+    RealFFTPlan2D_& operator=(const RealFFTPlan2D_&) = delete;
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int spectrum_cols() const { return spec_cols_; }
+    //半频谱第i行，列下标v对应频率v (0 <= v <= cols/2)
+    std::complex<T>* spectrum_row(int i) { return buffer_ + (size_t)i * spec_cols_; }
+    const std::complex<T>* spectrum_row(int i) const { return buffer_ + (size_t)i * spec_cols_; }
+    //实数视图：load()之后和inverse()之后，第i行的cols个实数
+    T* real_row(int i) { return reinterpret_cast<T*>(spectrum_row(i)); }
+    const T* real_row(int i) const { return reinterpret_cast<const T*>(spectrum_row(i)); }
+
+    bool load(const cv::Mat& img_gray);
+    void forward();
+    void inverse();
+
+    //行回调：参数为行号i和该行的cols个实数
+    typedef std::function<void(int, T*)> RowCallback;
+    //完整的频率域滤波，等价于 forward()、半频谱逐元素乘以mask (rows x spectrum_cols)、inverse()
+    //列方向的正变换、乘模板、逆变换在同一个分块缓冲区内连续完成，频谱不写回主缓冲区
+    //fill_row不为空时代替load()：在第i行R2C之前调用，由它写入该行的cols个实数
+    //row_done不为空时在第i行C2R之后立即调用，趁数据还在缓存中做后处理
+    //两个回调都可能在多个线程中同时被调用(每次处理不同的行)
+    void filter(const T* mask, const RowCallback& fill_row = RowCallback(),
+                const RowCallback& row_done = RowCallback());
+
+private:
+    void r2c_row(std::complex<T>* data) const;
+    void c2r_row(std::complex<T>* data) const;
+
+    int rows_;
+    int cols_;
+    int spec_cols_;            //cols_/2 + 1
+    std::complex<T>* buffer_;  //rows_ * spec_cols_
+    FFTPlan1D_<T> row_plan_;   //cols_为偶数时长度为cols_/2，否则为cols_
+    FFTPlan1D_<T> col_plan_;
+    std::vector<std::complex<T>> split_twiddle_; //拆分用的旋转因子 exp(-2*pi*i*k/cols), k < cols/2
+};
+
+typedef RealFFTPlan2D_<double> RealFFTPlan2D;
+typedef RealFFTPlan2D_<float> RealFFTPlan2Df;
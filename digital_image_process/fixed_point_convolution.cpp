@@ -0,0 +1,224 @@
+//8位图像的定点卷积：量化模板、16/32位整数累加、结果直接饱和到8位
+#include "fixed_point_convolution.h"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FIXED_HAVE_SSE2 1
+#endif
+
+using namespace std;
+using namespace cv;
+
+//---------------- 模板量化 ----------------
+
+const int FIXED_MAX_SHIFT = 20;
+const double FIXED_MAX_ACCUMULATOR = 1 << 30; //32位累加器留一位余量给舍入
+
+FixedPointMask quantize_mask(const double* mask, int m_width, int m_height) {
+    FixedPointMask q;
+    q.m_width = m_width;
+    q.m_height = m_height;
+    int size = m_width * m_height;
+    double max_abs = 0, sum_abs = 0;
+    bool integral = true;
+    for (int k = 0; k < size; ++k) {
+        max_abs = max(max_abs, fabs(mask[k]));
+        sum_abs += fabs(mask[k]);
+        if (mask[k] != floor(mask[k])) integral = false;
+    }
+    q.shift = 0;
+    if (!integral || max_abs > 32767) {
+        q.shift = FIXED_MAX_SHIFT;
+        while (q.shift > 0 && (ldexp(max_abs, q.shift) > 32767 ||
+                               ldexp(sum_abs, q.shift) * 255 > FIXED_MAX_ACCUMULATOR)) {
+            q.shift--;
+        }
+    }
+    if (ldexp(max_abs, q.shift) > 32767) {
+        cerr << "警告: 模板系数过大，定点化时截断到int16" << endl;
+    }
+    q.weights.resize(size);
+    double weight_error = 0;
+    int sum_weights = 0;
+    for (int k = 0; k < size; ++k) {
+        double w = max(-32767.0, min(32767.0, round(ldexp(mask[k], q.shift))));
+        q.weights[k] = (short)w;
+        sum_weights += abs((int)w);
+        weight_error += fabs(mask[k] - ldexp(w, -q.shift));
+    }
+    q.accumulate_16bit = integral && q.shift == 0 && sum_weights * 255 <= 32767;
+    q.max_output_error = 255 * weight_error;
+    return q;
+}
+
+FixedPointMask quantize_mask(const Mat& mask) {
+    if (mask.type() != CV_64FC1) {
+        cerr << "错误: 模板必须是CV_64FC1" << endl;
+        return quantize_mask(nullptr, 0, 0);
+    }
+    Mat m = mask.isContinuous() ? mask : mask.clone();
+    return quantize_mask(m.ptr<double>(), m.cols, m.rows);
+}
+
+//---------------- 逐点计算 (边界和每行剩余的像素) ----------------
+
+static inline uchar fixed_to_8u(int acc, int shift, bool absolute) {
+    if (shift > 0) acc = (acc + (1 << (shift - 1))) >> shift;
+    if (absolute) acc = abs(acc);
+    return saturate_cast<uchar>(acc);
+}
+
+template<typename Border>
+static inline uchar convolve_pixel_8u(const uchar* src, int width, int height,
+                                      const FixedPointMask& q, int i, int j, bool absolute) {
+    int center_h = q.m_height / 2, center_w = q.m_width / 2;
+    int acc = 0;
+    for (int n = 0; n < q.m_height; ++n) {
+        int y = Border::map(i + n - center_h, height);
+        if (y < 0) continue;
+        const uchar* s = src + (size_t)y * width;
+        const short* w = &q.weights[(size_t)n * q.m_width];
+        for (int m = 0; m < q.m_width; ++m) {
+            int x = Border::map(j + m - center_w, width);
+            if (x >= 0) acc += s[x] * w[m];
+        }
+    }
+    return fixed_to_8u(acc, q.shift, absolute);
+}
+
+//窗口完全在图像内的像素，不映射坐标
+static inline uchar convolve_interior_8u(const uchar* window, int width, const FixedPointMask& q, bool absolute) {
+    int acc = 0;
+    for (int n = 0; n < q.m_height; ++n) {
+        const uchar* s = window + (size_t)n * width;
+        const short* w = &q.weights[(size_t)n * q.m_width];
+        for (int m = 0; m < q.m_width; ++m) acc += s[m] * w[m];
+    }
+    return fixed_to_8u(acc, q.shift, absolute);
+}
+
+//---------------- SSE2 ----------------
+
+#ifdef FIXED_HAVE_SSE2
+//8个像素的窗口左上角为window，输出到dst[0..7]；taps为各模板位置相对window的偏移
+//weights每个模板位置占4个int (16字节)，保存已经广播好的权重
+static inline __m128i load_weight(const int* weights, int t) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + 4 * t));
+}
+
+static inline void convolve8_16bit(const uchar* window, uchar* dst, const int* taps, const int* weights,
+                                   int count, bool absolute) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (int t = 0; t < count; ++t) {
+        __m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(window + taps[t])), zero);
+        acc = _mm_add_epi16(acc, _mm_mullo_epi16(p, load_weight(weights, t)));
+    }
+    if (absolute) acc = _mm_max_epi16(acc, _mm_sub_epi16(zero, acc));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(acc, acc));
+}
+
+//模板位置两两一组：两个位置的像素交错成 (a0,b0,a1,b1,...)，与 (wa,wb,wa,wb,...) 做pmaddwd，
+//一条指令完成8次16位乘法和4次32位加法
+static inline void convolve8_32bit(const uchar* window, uchar* dst, const int* taps, const int* weights,
+                                   int pairs, int shift, bool absolute) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc_lo = zero, acc_hi = zero;
+    for (int p = 0; p < pairs; ++p) {
+        __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(window + taps[2 * p])), zero);
+        __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(window + taps[2 * p + 1])), zero);
+        __m128i w = load_weight(weights, p);
+        acc_lo = _mm_add_epi32(acc_lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+        acc_hi = _mm_add_epi32(acc_hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+    }
+    if (shift > 0) {
+        __m128i round = _mm_set1_epi32(1 << (shift - 1));
+        acc_lo = _mm_srai_epi32(_mm_add_epi32(acc_lo, round), shift);
+        acc_hi = _mm_srai_epi32(_mm_add_epi32(acc_hi, round), shift);
+    }
+    if (absolute) {
+        __m128i sign_lo = _mm_srai_epi32(acc_lo, 31), sign_hi = _mm_srai_epi32(acc_hi, 31);
+        acc_lo = _mm_sub_epi32(_mm_xor_si128(acc_lo, sign_lo), sign_lo);
+        acc_hi = _mm_sub_epi32(_mm_xor_si128(acc_hi, sign_hi), sign_hi);
+    }
+    __m128i packed = _mm_packs_epi32(acc_lo, acc_hi);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(packed, packed));
+}
+#endif
+
+//---------------- 卷积 ----------------
+
+//interior_only为true时不计算模板超出图像的像素(BORDER_MODE_IGNORE，随后清零)
+template<typename Border>
+static void convolve_8u_impl(const uchar* src, uchar* dst, int width, int height,
+                             const FixedPointMask& q, bool absolute, bool interior_only) {
+    int center_h = q.m_height / 2, center_w = q.m_width / 2;
+    int i_begin = min(center_h, height);
+    int i_end = max(i_begin, height - (q.m_height - 1 - center_h));
+    int j_begin = min(center_w, width);
+    int j_end = max(j_begin, width - (q.m_width - 1 - center_w));
+
+#ifdef FIXED_HAVE_SSE2
+    //模板位置相对窗口左上角的偏移；32位累加时补一个权重为0的位置凑成偶数
+    int size = q.m_width * q.m_height;
+    int pairs = (size + 1) / 2;
+    vector<int> taps(2 * pairs, 0);
+    for (int k = 0; k < size; ++k) taps[k] = (k / q.m_width) * width + k % q.m_width;
+    //16位累加：每个位置的权重重复8次；32位累加：每组 (wa,wb) 重复4次
+    vector<int> weights;
+    for (int p = 0; p < (q.accumulate_16bit ? size : pairs); ++p) {
+        int wa = (unsigned short)q.weights[q.accumulate_16bit ? p : 2 * p];
+        int wb = q.accumulate_16bit ? wa : ((2 * p + 1 < size) ? (unsigned short)q.weights[2 * p + 1] : 0);
+        weights.insert(weights.end(), 4, (int)((unsigned)wa | ((unsigned)wb << 16)));
+    }
+#endif
+
+    for (int i = 0; i < height; ++i) {
+        uchar* d = dst + (size_t)i * width;
+        if (i < i_begin || i >= i_end) {
+            if (interior_only) continue;
+            for (int j = 0; j < width; ++j) d[j] = convolve_pixel_8u<Border>(src, width, height, q, i, j, absolute);
+            continue;
+        }
+        if (!interior_only) {
+            for (int j = 0; j < j_begin; ++j) d[j] = convolve_pixel_8u<Border>(src, width, height, q, i, j, absolute);
+            for (int j = j_end; j < width; ++j) d[j] = convolve_pixel_8u<Border>(src, width, height, q, i, j, absolute);
+        }
+
+        const uchar* row = src + (size_t)(i - center_h) * width - center_w;
+        int j = j_begin;
+#ifdef FIXED_HAVE_SSE2
+        for (; j + 8 <= j_end; j += 8) {
+            if (q.accumulate_16bit) {
+                convolve8_16bit(row + j, d + j, taps.data(), weights.data(), size, absolute);
+            } else {
+                convolve8_32bit(row + j, d + j, taps.data(), weights.data(), pairs, q.shift, absolute);
+            }
+        }
+#endif
+        for (; j < j_end; ++j) d[j] = convolve_interior_8u(row + j, width, q, absolute);
+    }
+}
+
+void convolve_8u(const uchar* src, uchar* dst, int width, int height, const FixedPointMask& mask,
+                 BorderMode border, bool absolute) {
+    if (width <= 0 || height <= 0 || mask.m_width <= 0 || mask.m_height <= 0) return;
+    dispatch_border(border, [&](auto policy) {
+        convolve_8u_impl<decltype(policy)>(src, dst, width, height, mask, absolute, border == BORDER_MODE_IGNORE);
+    });
+    if (border == BORDER_MODE_IGNORE) clear_ignored_border(dst, width, height, mask.m_width, mask.m_height);
+}
+
+void convolve_8u(const Mat& src, Mat& dst, const FixedPointMask& mask, BorderMode border, bool absolute) {
+    if (src.type() != CV_8UC1) {
+        cerr << "错误: 定点卷积只支持8位单通道灰度图" << endl;
+        dst = Mat();
+        return;
+    }
+    Mat input = src.isContinuous() ? src : src.clone();
+    Mat result(src.size(), CV_8UC1);
+    convolve_8u(input.ptr<uchar>(), result.ptr<uchar>(), src.cols, src.rows, mask, border, absolute);
+    dst = result;
+}
@@ -0,0 +1,32 @@
+// fixed_point_convolution.h
+#pragma once
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "border.h"
+
+//定点化的模板：weights = round(mask * 2^shift)，用int16保存
+//整数模板(拉普拉斯、Sobel等)shift = 0，没有量化误差；
+//其余模板取尽量大的shift，同时保证 |w| <= 32767、sum|w| * 255 不超出32位累加器
+struct FixedPointMask {
+    int m_width, m_height;
+    int shift;
+    std::vector<short> weights;
+    bool accumulate_16bit;   //整数模板且 sum|w| * 255 <= 32767 时用16位累加，每次处理的像素多一倍
+    double max_output_error; //量化引起的输出误差上界 255 * sum|mask - w/2^shift| (不含最后的舍入)
+};
+
+//mask为 m_width x m_height 的行优先数组
+FixedPointMask quantize_mask(const double* mask, int m_width, int m_height);
+//mask为CV_64FC1
+FixedPointMask quantize_mask(const cv::Mat& mask);
+
+//8位图像的定点卷积(模板不翻转，与convolve相同)，结果直接饱和到8位：
+//absolute为false时截断到[0,255] (同saturate_cast)，为true时先取绝对值 (同convertScaleAbs)
+//内部的像素x86上用SSE2：8个像素一组，16位累加用pmullw，32位累加把两个模板位置交错后用pmaddwd
+void convolve_8u(const uchar* src, uchar* dst, int width, int height, const FixedPointMask& mask,
+                 BorderMode border = BORDER_MODE_ZERO, bool absolute = false);
+
+//Mat版本：src为CV_8UC1，dst为CV_8UC1
+void convolve_8u(const cv::Mat& src, cv::Mat& dst, const FixedPointMask& mask,
+                 BorderMode border = BORDER_MODE_ZERO, bool absolute = false);
@@ -0,0 +1,285 @@
+//频率域滤波流水线：可替换的传递函数 + 模板缓存 + 合并内存遍历的滤波过程
+#include "frequency_filter.h"
+#include <iostream>
+#include <cmath>
+#include <cfloat>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <tuple>
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+//---------------- 传递函数 ----------------
+
+double TransferFunction::operator()(double u, double v) const {
+    double d2 = u * u + v * v;
+    switch (type) {
+    case TRANSFER_IDEAL_HIGH_PASS:
+        return (max(fabs(u), fabs(v)) < d0) ? 0.0 : 1.0;
+    case TRANSFER_IDEAL_LOW_PASS:
+        return (max(fabs(u), fabs(v)) < d0) ? 1.0 : 0.0;
+    case TRANSFER_GAUSSIAN_HIGH_PASS:
+        return 1.0 - exp(-d2 / (2 * d0 * d0));
+    case TRANSFER_GAUSSIAN_LOW_PASS:
+        return exp(-d2 / (2 * d0 * d0));
+    case TRANSFER_BUTTERWORTH_HIGH_PASS:
+    case TRANSFER_BUTTERWORTH_LOW_PASS: {
+        double distance = sqrt(d2);
+        // 避免除以0
+        if (distance == 0) distance = 1e-9;
+        double high = 1.0 / (1.0 + pow(d0 / distance, 2.0 * n));
+        return (type == TRANSFER_BUTTERWORTH_HIGH_PASS) ? high : 1.0 - high;
+    }
+    case TRANSFER_GAUSSIAN_BAND_PASS:
+    case TRANSFER_GAUSSIAN_BAND_REJECT: {
+        double distance = sqrt(d2);
+        if (distance == 0) distance = 1e-9;
+        double t = (d2 - d0 * d0) / (distance * width);
+        double reject = 1.0 - exp(-t * t);
+        return (type == TRANSFER_GAUSSIAN_BAND_REJECT) ? reject : 1.0 - reject;
+    }
+    case TRANSFER_GAUSSIAN_NOTCH_REJECT: {
+        double d1 = (u - u0) * (u - u0) + (v - v0) * (v - v0);
+        double d2n = (u + u0) * (u + u0) + (v + v0) * (v + v0);
+        return (1.0 - exp(-d1 / (2 * d0 * d0))) * (1.0 - exp(-d2n / (2 * d0 * d0)));
+    }
+    case TRANSFER_HOMOMORPHIC:
+        return (gamma_h - gamma_l) * (1.0 - exp(-c * d2 / (d0 * d0))) + gamma_l;
+    case TRANSFER_CUSTOM:
+        return custom ? custom(u, v) : 1.0;
+    }
+    return 1.0;
+}
+
+bool TransferFunction::operator<(const TransferFunction& other) const {
+    return tie(type, d0, n, width, u0, v0, gamma_l, gamma_h, c, custom_id)
+         < tie(other.type, other.d0, other.n, other.width, other.u0, other.v0,
+               other.gamma_l, other.gamma_h, other.c, other.custom_id);
+}
+
+static TransferFunction make_transfer(TransferType type, double d0) {
+    TransferFunction h;
+    h.type = type;
+    h.d0 = d0;
+    h.n = 0;
+    h.width = 0;
+    h.u0 = h.v0 = 0;
+    h.gamma_l = h.gamma_h = 1.0;
+    h.c = 1.0;
+    h.custom_id = 0;
+    return h;
+}
+
+TransferFunction TransferFunction::ideal_high_pass(double d0) {
+    return make_transfer(TRANSFER_IDEAL_HIGH_PASS, d0);
+}
+
+TransferFunction TransferFunction::ideal_low_pass(double d0) {
+    return make_transfer(TRANSFER_IDEAL_LOW_PASS, d0);
+}
+
+TransferFunction TransferFunction::gaussian_high_pass(double d0) {
+    return make_transfer(TRANSFER_GAUSSIAN_HIGH_PASS, d0);
+}
+
+TransferFunction TransferFunction::gaussian_low_pass(double d0) {
+    return make_transfer(TRANSFER_GAUSSIAN_LOW_PASS, d0);
+}
+
+TransferFunction TransferFunction::butterworth_high_pass(double d0, int n) {
+    TransferFunction h = make_transfer(TRANSFER_BUTTERWORTH_HIGH_PASS, d0);
+    h.n = n;
+    return h;
+}
+
+TransferFunction TransferFunction::butterworth_low_pass(double d0, int n) {
+    TransferFunction h = make_transfer(TRANSFER_BUTTERWORTH_LOW_PASS, d0);
+    h.n = n;
+    return h;
+}
+
+TransferFunction TransferFunction::gaussian_band_pass(double c0, double width) {
+    TransferFunction h = make_transfer(TRANSFER_GAUSSIAN_BAND_PASS, c0);
+    h.width = width;
+    return h;
+}
+
+TransferFunction TransferFunction::gaussian_band_reject(double c0, double width) {
+    TransferFunction h = make_transfer(TRANSFER_GAUSSIAN_BAND_REJECT, c0);
+    h.width = width;
+    return h;
+}
+
+TransferFunction TransferFunction::gaussian_notch_reject(double u0, double v0, double d0) {
+    TransferFunction h = make_transfer(TRANSFER_GAUSSIAN_NOTCH_REJECT, d0);
+    h.u0 = u0;
+    h.v0 = v0;
+    return h;
+}
+
+TransferFunction TransferFunction::homomorphic(double d0, double gamma_l, double gamma_h, double c) {
+    TransferFunction h = make_transfer(TRANSFER_HOMOMORPHIC, d0);
+    h.gamma_l = gamma_l;
+    h.gamma_h = gamma_h;
+    h.c = c;
+    return h;
+}
+
+TransferFunction TransferFunction::make_custom(const string& name, function<double(double, double)> func) {
+    static atomic<unsigned long long> next_id(1);
+    TransferFunction h = make_transfer(TRANSFER_CUSTOM, 0);
+    h.name = name;
+    h.custom_id = next_id++;
+    h.custom = func;
+    return h;
+}
+
+//---------------- 模板缓存 ----------------
+
+//半频谱第i行对应的纵向频率：下标超过一半的行对应负频率
+static inline int spectrum_row_frequency(int i, int rows) {
+    return (i < (rows + 1) / 2) ? i : i - rows;
+}
+
+template<typename T>
+static vector<T> build_transfer_mask(int rows, int cols, const TransferFunction& h) {
+    int spec_cols = cols / 2 + 1;
+    vector<T> mask((size_t)rows * spec_cols);
+    for (int i = 0; i < rows; ++i) {
+        T* m = &mask[(size_t)i * spec_cols];
+        double u = spectrum_row_frequency(i, rows);
+        for (int j = 0; j < spec_cols; ++j) m[j] = static_cast<T>(h(u, j));
+    }
+    return mask;
+}
+
+struct TransferMaskKey {
+    int rows;
+    int cols;
+    TransferFunction h;
+
+    bool operator<(const TransferMaskKey& other) const {
+        if (rows != other.rows) return rows < other.rows;
+        if (cols != other.cols) return cols < other.cols;
+        return h < other.h;
+    }
+};
+
+const size_t TRANSFER_MASK_CACHE_ENTRIES = 16;
+
+template<typename T>
+struct TransferMaskCache {
+    mutex lock;
+    map<TransferMaskKey, shared_ptr<const vector<T>>> masks;
+};
+
+template<typename T>
+static TransferMaskCache<T>& transfer_mask_cache() {
+    static TransferMaskCache<T> cache;
+    return cache;
+}
+
+template<typename T>
+shared_ptr<const vector<T>> get_transfer_mask(int rows, int cols, const TransferFunction& h) {
+    TransferMaskCache<T>& cache = transfer_mask_cache<T>();
+    TransferMaskKey key = { rows, cols, h };
+    lock_guard<mutex> guard(cache.lock);
+    auto it = cache.masks.find(key);
+    if (it != cache.masks.end()) return it->second;
+    if (cache.masks.size() >= TRANSFER_MASK_CACHE_ENTRIES) cache.masks.clear();
+    auto mask = make_shared<const vector<T>>(build_transfer_mask<T>(rows, cols, h));
+    cache.masks[key] = mask;
+    return mask;
+}
+
+void clear_transfer_mask_cache() {
+    {
+        lock_guard<mutex> guard(transfer_mask_cache<float>().lock);
+        transfer_mask_cache<float>().masks.clear();
+    }
+    lock_guard<mutex> guard(transfer_mask_cache<double>().lock);
+    transfer_mask_cache<double>().masks.clear();
+}
+
+//---------------- 滤波流水线 ----------------
+
+template<typename T>
+FrequencyFilter_<T>::FrequencyFilter_(Size image_size)
+    : image_size_(image_size),
+      plan_(getOptimalDFTSize(image_size.height), getOptimalDFTSize(image_size.width)),
+      row_min_(plan_.rows()), row_max_(plan_.rows()) {
+}
+
+template<typename T>
+Mat FrequencyFilter_<T>::apply(const Mat& img_gray, const TransferFunction& h) {
+    if (img_gray.type() != CV_8UC1 || img_gray.size() != image_size_) {
+        cerr << "错误: 输入图像必须是8位单通道灰度图，且尺寸为 "
+             << image_size_.width << "x" << image_size_.height << endl;
+        return Mat();
+    }
+    shared_ptr<const vector<T>> mask = get_transfer_mask<T>(plan_.rows(), plan_.cols(), h);
+    const bool homomorphic = h.is_homomorphic();
+
+    //同态滤波先取 ln(1 + f)，8位输入用查找表
+    T lut[256];
+    for (int k = 0; k < 256; ++k) lut[k] = homomorphic ? static_cast<T>(log1p((double)k)) : static_cast<T>(k);
+
+    int rows = image_size_.height;
+    int cols = image_size_.width;
+    int plan_cols = plan_.cols();
+
+    //读入一行像素，右侧和下方补零
+    auto fill_row = [&](int i, T* dst) {
+        if (i < rows) {
+            const uchar* src = img_gray.ptr<uchar>(i);
+            for (int j = 0; j < cols; ++j) dst[j] = lut[src[j]];
+            fill(dst + cols, dst + plan_cols, T(0));
+        } else {
+            fill(dst, dst + plan_cols, T(0));
+        }
+    };
+
+    //逆变换后的一行：(同态滤波时先取指数) 取绝对值，并记录该行的最小、最大值
+    auto row_done = [&](int i, T* x) {
+        T lo = numeric_limits<T>::max();
+        T hi = 0;
+        for (int j = 0; j < plan_cols; ++j) {
+            T v = homomorphic ? static_cast<T>(expm1((double)x[j])) : x[j];
+            v = fabs(v);
+            x[j] = v;
+            lo = min(lo, v);
+            hi = max(hi, v);
+        }
+        row_min_[i] = lo;
+        row_max_[i] = hi;
+    };
+
+    plan_.filter(mask->data(), fill_row, row_done);
+
+    //与 normalize(NORM_MINMAX, 0..255) 一致：最值取自补零后的整幅结果
+    double min_val = *min_element(row_min_.begin(), row_min_.end());
+    double max_val = *max_element(row_max_.begin(), row_max_.end());
+    double scale = (max_val - min_val > DBL_EPSILON) ? 255.0 / (max_val - min_val) : 0.0;
+    double shift = -min_val * scale;
+
+    //归一化、转8位和裁剪一遍完成
+    Mat result(rows, cols, CV_8UC1);
+    parallel_for_(Range(0, rows), [&](const Range& r) {
+        for (int i = r.start; i < r.end; ++i) {
+            const T* src = plan_.real_row(i);
+            uchar* dst = result.ptr<uchar>(i);
+            for (int j = 0; j < cols; ++j) dst[j] = saturate_cast<uchar>(src[j] * scale + shift);
+        }
+    }, fft_num_threads());
+    return result;
+}
+
+//显式实例化float和double两种精度
+template shared_ptr<const vector<float>> get_transfer_mask<float>(int, int, const TransferFunction&);
+template shared_ptr<const vector<double>> get_transfer_mask<double>(int, int, const TransferFunction&);
+template class FrequencyFilter_<float>;
+template class FrequencyFilter_<double>;
@@ -0,0 +1,99 @@
+// frequency_filter.h
+#pragma once
+
+#include <string>
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include "fft_plan.h"
+
+//频率域滤波器的传递函数 H(u,v)
+//u、v为未移位频谱上的频率(以频点为单位，可正可负)，实数图像要求 H(u,v) = H(-u,-v)
+enum TransferType {
+    TRANSFER_IDEAL_HIGH_PASS,
+    TRANSFER_IDEAL_LOW_PASS,
+    TRANSFER_GAUSSIAN_HIGH_PASS,
+    TRANSFER_GAUSSIAN_LOW_PASS,
+    TRANSFER_BUTTERWORTH_HIGH_PASS,
+    TRANSFER_BUTTERWORTH_LOW_PASS,
+    TRANSFER_GAUSSIAN_BAND_PASS,
+    TRANSFER_GAUSSIAN_BAND_REJECT,
+    TRANSFER_GAUSSIAN_NOTCH_REJECT,
+    TRANSFER_HOMOMORPHIC,
+    TRANSFER_CUSTOM
+};
+
+//传递函数的类型和参数，用工厂函数创建；同时作为模板缓存的键
+struct TransferFunction {
+    TransferType type;
+    double d0;       //截止频率；带通/带阻为中心频率；陷波为半径
+    int n;           //巴特沃斯阶数
+    double width;    //带通/带阻的带宽W
+    double u0, v0;   //陷波中心 (另一个陷波在 (-u0,-v0))
+    double gamma_l;  //同态滤波：低频增益 (<1，压缩照度)
+    double gamma_h;  //同态滤波：高频增益 (>1，增强反射分量)
+    double c;        //同态滤波：过渡的陡峭程度
+    std::string name; //自定义传递函数的名字，只用于显示
+    unsigned long long custom_id; //每次make_custom分配一个新编号，缓存按编号区分自定义函数；其他类型为0
+    std::function<double(double, double)> custom;
+
+    //计算频率 (u,v) 处的 H(u,v)
+    double operator()(double u, double v) const;
+    //同态滤波要先取对数、滤波后再取指数
+    bool is_homomorphic() const { return type == TRANSFER_HOMOMORPHIC; }
+    //按类型和参数比较(自定义函数按custom_id比较，复制得到的对象编号相同)
+    bool operator<(const TransferFunction& other) const;
+
+    //理想滤波器的低频区域为对称的方形 max(|u|,|v|) < D0；原实现在移位后的频谱上置零半开区间[c-D0, c+D0)，
+    //负频率一侧多一行一列，而R2C半频谱要求模板共轭对称 H(u,v) = H(-u,-v)，所以改为对称区域，结果与原实现略有不同
+    static TransferFunction ideal_high_pass(double d0);
+    static TransferFunction ideal_low_pass(double d0);
+    static TransferFunction gaussian_high_pass(double d0);
+    static TransferFunction gaussian_low_pass(double d0);
+    static TransferFunction butterworth_high_pass(double d0, int n);
+    static TransferFunction butterworth_low_pass(double d0, int n);
+    //高斯带阻 H = 1 - exp(-((D^2 - C0^2) / (D*W))^2)，带通为 1 - 带阻
+    static TransferFunction gaussian_band_pass(double c0, double width);
+    static TransferFunction gaussian_band_reject(double c0, double width);
+    //以 (u0,v0) 和 (-u0,-v0) 为中心、半径D0的一对高斯陷波
+    static TransferFunction gaussian_notch_reject(double u0, double v0, double d0);
+    //H = (gamma_h - gamma_l) * (1 - exp(-c * D^2 / D0^2)) + gamma_l
+    static TransferFunction homomorphic(double d0, double gamma_l, double gamma_h, double c);
+    //任意的 H(u,v)；每次调用都是一个新的函数，即使name相同或lambda相同也不共用缓存的模板，
+    //同一个函数多次使用时应保存返回值，而不是每次重新make_custom
+    static TransferFunction make_custom(const std::string& name, std::function<double(double, double)> h);
+};
+
+//按 (补零后的尺寸, 传递函数) 缓存算好的模板，同一参数只计算一次 exp/sqrt/pow
+//模板按未移位的半频谱排列 (rows x (cols/2+1))，与RealFFTPlan2D_的频谱逐元素对应
+//多个线程可以同时使用；超过16组参数时清空重来
+template<typename T>
+std::shared_ptr<const std::vector<T>> get_transfer_mask(int rows, int cols, const TransferFunction& h);
+void clear_transfer_mask_cache();
+
+//频率域滤波流水线：补零、R2C FFT、乘传递函数、C2R IFFT、取绝对值、归一化到0-255、裁剪
+//  1. 读入像素(同态滤波时查表取对数)与行R2C在同一遍完成，不单独补零拷贝
+//  2. 列方向的正变换、乘模板、逆变换在分块缓冲区内完成
+//  3. 行C2R之后立即统计该行的最小、最大值
+//  4. 最后一遍同时完成取绝对值、归一化、转8位和裁剪，只写原始尺寸的部分
+//同一尺寸的图像(如视频的每一帧)反复调用apply，计划和模板都只准备一次
+template<typename T>
+class FrequencyFilter_ {
+public:
+    //image_size为输入图像尺寸，内部补零到getOptimalDFTSize
+    explicit FrequencyFilter_(cv::Size image_size);
+
+    cv::Size image_size() const { return image_size_; }
+    RealFFTPlan2D_<T>& plan() { return plan_; }
+
+    //img_gray必须是CV_8UC1且尺寸为image_size；返回CV_8UC1结果，出错时返回空Mat
+    cv::Mat apply(const cv::Mat& img_gray, const TransferFunction& h);
+
+private:
+    cv::Size image_size_;
+    RealFFTPlan2D_<T> plan_;
+    std::vector<T> row_min_; //每行|x|的最小、最大值，行C2R后填入
+    std::vector<T> row_max_;
+};
+
+typedef FrequencyFilter_<double> FrequencyFilter;
+typedef FrequencyFilter_<float> FrequencyFilterf;
@@ -0,0 +1,66 @@
+//全局阈值：大津法与迭代法
+#include "global_threshold.h"
+#include "histogram.h"
+#include "otsu.h"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+int iterative_threshold(const vector<int>& hist, double delta_T, int* iterations) {
+    int levels = (int)hist.size();
+    if (levels == 0) {
+        cerr << "错误: 直方图为空" << endl;
+        return -1;
+    }
+    //P[k]、S[k]为灰度 < k 的像素数、灰度和 (整数累加，与逐像素求和完全相同)
+    vector<long long> P(levels + 1, 0), S(levels + 1, 0);
+    for (int i = 0; i < levels; ++i) {
+        P[i + 1] = P[i] + hist[i];
+        S[i + 1] = S[i] + (long long)i * hist[i];
+    }
+    long long total = P[levels];
+    if (total == 0) {
+        cerr << "错误: 直方图为空" << endl;
+        return -1;
+    }
+
+    //初始阈值为平均灰度
+    double current_T = (double)S[levels] / total;
+    double previous_T = 0;
+    int iteration_count = 0;
+    while (fabs(current_T - previous_T) > delta_T) {
+        previous_T = current_T;
+        iteration_count++;
+        //灰度为整数，v <= T 等价于 v <= floor(T)，G2为[0, k]，G1为(k, L-1]
+        int k = (int)min(max(floor(current_T), -1.0), (double)levels - 1);
+        long long count_g2 = P[k + 1], sum_g2 = S[k + 1];
+        long long count_g1 = total - count_g2, sum_g1 = S[levels] - sum_g2;
+
+        double mu1 = (count_g1 > 0) ? static_cast<double>(sum_g1) / count_g1 : 0;
+        double mu2 = (count_g2 > 0) ? static_cast<double>(sum_g2) / count_g2 : 0;
+        current_T = (mu1 + mu2) / 2.0;
+    }
+    if (iterations) *iterations = iteration_count;
+    return static_cast<int>(current_T);
+}
+
+int global_threshold(const vector<int>& hist, GlobalThresholdMethod method) {
+    switch (method) {
+    case GLOBAL_THRESHOLD_OTSU: return otsu_threshold(hist);
+    case GLOBAL_THRESHOLD_ITERATIVE: return iterative_threshold(hist);
+    default:
+        cerr << "错误: 未知的全局阈值方法" << endl;
+        return -1;
+    }
+}
+
+int global_threshold(const Mat& img_gray, GlobalThresholdMethod method) {
+    if (img_gray.type() != CV_8UC1) {
+        cerr << "错误: 输入图像必须是8位单通道灰度图" << endl;
+        return -1;
+    }
+    return global_threshold(calc_histogram(img_gray), method);
+}
@@ -0,0 +1,23 @@
+// global_threshold.h
+#pragma once
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+//全局阈值的计算方法
+enum GlobalThresholdMethod {
+    GLOBAL_THRESHOLD_OTSU = 0,      //大津法：类间方差最大(见otsu.h)
+    GLOBAL_THRESHOLD_ITERATIVE = 1  //迭代法：T = 两类均值的平均，直到T的变化不超过delta_T
+};
+
+//迭代法全局阈值，只用直方图：先求一次累积像素数、累积灰度和，
+//之后每次迭代两类的像素数和灰度和都由累积表查2项得到，O(1)，不再扫描像素
+//初始T为图像平均灰度，灰度 > T 为一类，<= T 为另一类；iterations不为空时返回迭代次数
+//与逐像素迭代的结果完全相同；hist为空时返回-1
+int iterative_threshold(const std::vector<int>& hist, double delta_T = 1.0, int* iterations = nullptr);
+
+//按method计算全局阈值，img_gray为CV_8UC1；出错时返回-1
+//灰度 > 阈值 的像素为前景，与threshold(THRESH_BINARY)一致
+int global_threshold(const cv::Mat& img_gray, GlobalThresholdMethod method);
+//已有直方图时直接计算
+int global_threshold(const std::vector<int>& hist, GlobalThresholdMethod method);
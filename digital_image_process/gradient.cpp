@@ -0,0 +1,192 @@
+//一次扫描的Sobel梯度：Gx、Gy、幅值、量化方向
+#include "gradient.h"
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define GRADIENT_HAVE_SSE2 1
+#endif
+
+using namespace std;
+using namespace cv;
+
+//tan(22.5°) * 2^15，tan(67.5°) = tan(22.5°) + 2
+const int GRADIENT_TG22 = 13573;
+const int GRADIENT_SHIFT = 15;
+
+//p0、p1、p2为左右各补一个像素的三行，输出第j个像素对应p[j..j+2]
+static void sobel_row(const uchar* p0, const uchar* p1, const uchar* p2,
+                      short* gx, short* gy, int width) {
+    int j = 0;
+#ifdef GRADIENT_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    auto load = [&](const uchar* p) {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), zero);
+    };
+    for (; j + 8 <= width; j += 8) {
+        __m128i a0 = load(p0 + j), b0 = load(p0 + j + 1), c0 = load(p0 + j + 2);
+        __m128i a1 = load(p1 + j), c1 = load(p1 + j + 2);
+        __m128i a2 = load(p2 + j), b2 = load(p2 + j + 1), c2 = load(p2 + j + 2);
+        __m128i dx = _mm_add_epi16(_mm_sub_epi16(c0, a0), _mm_sub_epi16(c2, a2));
+        dx = _mm_add_epi16(dx, _mm_slli_epi16(_mm_sub_epi16(c1, a1), 1));
+        __m128i dy = _mm_add_epi16(_mm_sub_epi16(a2, a0), _mm_sub_epi16(c2, c0));
+        dy = _mm_add_epi16(dy, _mm_slli_epi16(_mm_sub_epi16(b2, b0), 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(gx + j), dx);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(gy + j), dy);
+    }
+#endif
+    for (; j < width; ++j) {
+        gx[j] = (short)((p0[j + 2] - p0[j]) + 2 * (p1[j + 2] - p1[j]) + (p2[j + 2] - p2[j]));
+        gy[j] = (short)((p2[j] + 2 * p2[j + 1] + p2[j + 2]) - (p0[j] + 2 * p0[j + 1] + p0[j + 2]));
+    }
+}
+
+static void magnitude_row(const short* gx, const short* gy, ushort* dst, int width, GradientNorm norm) {
+    int j = 0;
+#ifdef GRADIENT_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; j + 8 <= width; j += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gx + j));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gy + j));
+        __m128i m;
+        if (norm == GRADIENT_NORM_L1) {
+            m = _mm_add_epi16(_mm_max_epi16(x, _mm_sub_epi16(zero, x)), _mm_max_epi16(y, _mm_sub_epi16(zero, y)));
+        } else {
+            //(x,y)交错后pmaddwd得到 x^2 + y^2，sqrt后按当前舍入方式(最近偶数)取整
+            __m128i lo = _mm_unpacklo_epi16(x, y), hi = _mm_unpackhi_epi16(x, y);
+            __m128 flo = _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lo, lo)));
+            __m128 fhi = _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(hi, hi)));
+            m = _mm_packs_epi32(_mm_cvtps_epi32(flo), _mm_cvtps_epi32(fhi)); //最大1443，不会饱和
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j), m);
+    }
+#endif
+    for (; j < width; ++j) {
+        int x = gx[j], y = gy[j];
+        dst[j] = (ushort)(norm == GRADIENT_NORM_L1 ? abs(x) + abs(y) : cvRound(sqrtf((float)(x * x + y * y))));
+    }
+}
+
+//与 convertScaleAbs(Gx)、convertScaleAbs(Gy) 再 addWeighted(0.5, 0.5) 相同：和为奇数时舍入到偶数
+static void edge_row(const short* gx, const short* gy, uchar* dst, int width) {
+    int j = 0;
+#ifdef GRADIENT_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128(), max8 = _mm_set1_epi16(255), one = _mm_set1_epi16(1);
+    for (; j + 8 <= width; j += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gx + j));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gy + j));
+        x = _mm_min_epi16(_mm_max_epi16(x, _mm_sub_epi16(zero, x)), max8);
+        y = _mm_min_epi16(_mm_max_epi16(y, _mm_sub_epi16(zero, y)), max8);
+        __m128i s = _mm_add_epi16(x, y);
+        s = _mm_srli_epi16(_mm_add_epi16(s, _mm_and_si128(_mm_srli_epi16(s, 1), one)), 1);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + j), _mm_packus_epi16(s, s));
+    }
+#endif
+    for (; j < width; ++j) {
+        int s = min(abs((int)gx[j]), 255) + min(abs((int)gy[j]), 255);
+        dst[j] = (uchar)((s + ((s >> 1) & 1)) >> 1);
+    }
+}
+
+static void angle_row(const short* gx, const short* gy, uchar* dst, int width, int bins) {
+    if (bins == 4) {
+        for (int j = 0; j < width; ++j) {
+            int x = gx[j], y = gy[j];
+            int ax = abs(x), ay = abs(y) << GRADIENT_SHIFT;
+            int tg22 = ax * GRADIENT_TG22;
+            int tg67 = tg22 + (ax << (GRADIENT_SHIFT + 1));
+            //随机纹理上分支预测失败很多，用比较结果直接算区间
+            int diagonal = (x ^ y) < 0 ? 3 : 1;
+            int bin = ay > tg67 ? 2 : diagonal;
+            dst[j] = (uchar)(ay <= tg22 ? 0 : bin);
+        }
+        return;
+    }
+    const float to_bin = (float)(bins / CV_PI);
+    for (int j = 0; j < width; ++j) {
+        float a = atan2f((float)gy[j], (float)gx[j]);
+        if (a < 0) a += (float)CV_PI;
+        int bin = (int)(a * to_bin + 0.5f);
+        dst[j] = (uchar)(bin >= bins ? bin - bins : bin);
+    }
+}
+
+template<typename Border>
+static void sobel_rows(const Mat& src, SobelGradient& result, int outputs, GradientNorm norm,
+                       int bins, int begin, int end) {
+    int width = src.cols, height = src.rows;
+    //每个线程的三行补边缓冲区和Gx、Gy行缓冲区
+    static thread_local vector<uchar> padded;
+    static thread_local vector<short> gx_row, gy_row;
+    size_t stride = width + 2;
+    padded.resize(3 * stride);
+    gx_row.resize(width);
+    gy_row.resize(width);
+    int left = Border::map(-1, width), right = Border::map(width, width);
+
+    for (int i = begin; i < end; ++i) {
+        const uchar* rows[3];
+        for (int k = 0; k < 3; ++k) {
+            uchar* p = &padded[k * stride];
+            int y = Border::map(i - 1 + k, height);
+            if (y < 0) {
+                memset(p, 0, stride);
+            } else {
+                const uchar* s = src.ptr<uchar>(y);
+                memcpy(p + 1, s, width);
+                p[0] = left < 0 ? 0 : s[left];
+                p[width + 1] = right < 0 ? 0 : s[right];
+            }
+            rows[k] = p;
+        }
+        short* gx = (outputs & GRADIENT_GX) ? result.gx.ptr<short>(i) : gx_row.data();
+        short* gy = (outputs & GRADIENT_GY) ? result.gy.ptr<short>(i) : gy_row.data();
+        sobel_row(rows[0], rows[1], rows[2], gx, gy, width);
+        if (outputs & GRADIENT_MAGNITUDE) magnitude_row(gx, gy, result.magnitude.ptr<ushort>(i), width, norm);
+        if (outputs & GRADIENT_EDGE_8U) edge_row(gx, gy, result.edge.ptr<uchar>(i), width);
+        if (outputs & GRADIENT_ANGLE) angle_row(gx, gy, result.angle.ptr<uchar>(i), width, bins);
+    }
+}
+
+void sobel_gradient(const Mat& src, SobelGradient& result, int outputs,
+                    GradientNorm norm, int angle_bins, BorderMode border) {
+    if (src.type() != CV_8UC1) {
+        cerr << "错误: Sobel梯度只支持8位单通道灰度图" << endl;
+        result = SobelGradient();
+        return;
+    }
+    if ((outputs & GRADIENT_ANGLE) && (angle_bins < 1 || angle_bins > 255)) {
+        cerr << "错误: 方向量化的区间数必须在1到255之间" << endl;
+        result = SobelGradient();
+        return;
+    }
+    //只为请求的输出分配，尺寸、类型相同时create不重新分配
+    auto prepare = [&](Mat& m, int flag, int type) {
+        if (outputs & flag) {
+            m.create(src.size(), type);
+        } else {
+            m = Mat();
+        }
+    };
+    prepare(result.gx, GRADIENT_GX, CV_16SC1);
+    prepare(result.gy, GRADIENT_GY, CV_16SC1);
+    prepare(result.magnitude, GRADIENT_MAGNITUDE, CV_16UC1);
+    prepare(result.angle, GRADIENT_ANGLE, CV_8UC1);
+    prepare(result.edge, GRADIENT_EDGE_8U, CV_8UC1);
+    if (src.empty()) return;
+
+    //BORDER_MODE_IGNORE按零填充计算，最后把边界清零
+    dispatch_border(border, [&](auto policy) {
+        parallel_for_(Range(0, src.rows), [&](const Range& r) {
+            sobel_rows<decltype(policy)>(src, result, outputs, norm, angle_bins, r.start, r.end);
+        });
+    });
+    if (border == BORDER_MODE_IGNORE) {
+        for (Mat* m : {&result.gx, &result.gy, &result.magnitude, &result.angle, &result.edge}) {
+            clear_ignored_border_3x3(*m);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+// gradient.h
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "border.h"
+
+//sobel_gradient需要的输出，可以按位组合
+enum GradientOutput {
+    GRADIENT_GX = 1,        //CV_16SC1，x方向梯度 (模板 -1 0 1 / -2 0 2 / -1 0 1)
+    GRADIENT_GY = 2,        //CV_16SC1，y方向梯度 (模板 -1 -2 -1 / 0 0 0 / 1 2 1)
+    GRADIENT_MAGNITUDE = 4, //CV_16UC1，梯度幅值，按GradientNorm计算
+    GRADIENT_ANGLE = 8,     //CV_8UC1，量化后的梯度方向 0..angle_bins-1
+    GRADIENT_EDGE_8U = 16   //CV_8UC1，(min(|Gx|,255) + min(|Gy|,255)) / 2，与convertScaleAbs + addWeighted的结果相同
+};
+
+enum GradientNorm {
+    GRADIENT_NORM_L1 = 1, //|Gx| + |Gy|
+    GRADIENT_NORM_L2 = 2  //round(sqrt(Gx^2 + Gy^2))
+};
+
+//sobel_gradient的结果，没有请求的输出为空；同一个对象反复使用时不重新分配
+struct SobelGradient {
+    cv::Mat gx, gy;
+    cv::Mat magnitude;
+    cv::Mat angle;
+    cv::Mat edge;
+};
+
+//一次扫描同时计算Sobel梯度的多种输出：每个3x3邻域只读一次，Gx、Gy在16位整数中算出，
+//其余输出都从这一行的Gx、Gy直接得到，不产生整幅的中间图像
+//方向按图像坐标(y向下)取 atan2(Gy, Gx) 折算到[0,180)，第k个区间以 k*180/angle_bins 度为中心；
+//angle_bins = 4时与Canny相同(0、45、90、135度)，用整数比较，不调用atan2
+//src为CV_8UC1，outputs为GradientOutput的组合
+void sobel_gradient(const cv::Mat& src, SobelGradient& result, int outputs,
+                    GradientNorm norm = GRADIENT_NORM_L1, int angle_bins = 4,
+                    BorderMode border = BORDER_MODE_ZERO);
@@ -0,0 +1,96 @@
+//多线程灰度直方图
+#include "histogram.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+//每个线程至少统计这么多像素，太小的图像不值得分线程
+const int HISTOGRAM_MIN_PIXELS_PER_THREAD = 1 << 16;
+//8位直方图每个线程的子直方图个数
+const int HISTOGRAM_LANES = 4;
+
+//8位：相邻的4个像素分别累加到4个子直方图，每次展开4个像素
+static void count_rows_8u(const Mat& src, const Mat& mask, const Rect& roi, int begin, int end, int* lanes) {
+    int* h0 = lanes;
+    int* h1 = lanes + 256;
+    int* h2 = lanes + 512;
+    int* h3 = lanes + 768;
+    for (int i = begin; i < end; ++i) {
+        const uchar* p = src.ptr<uchar>(roi.y + i) + roi.x;
+        int n = roi.width;
+        if (!mask.empty()) {
+            const uchar* m = mask.ptr<uchar>(roi.y + i) + roi.x;
+            for (int j = 0; j < n; ++j) {
+                if (m[j]) h0[p[j]]++;
+            }
+            continue;
+        }
+        int j = 0;
+        for (; j + 4 <= n; j += 4) {
+            h0[p[j]]++;
+            h1[p[j + 1]]++;
+            h2[p[j + 2]]++;
+            h3[p[j + 3]]++;
+        }
+        for (; j < n; ++j) h0[p[j]]++;
+    }
+    for (int v = 0; v < 256; ++v) h0[v] += h1[v] + h2[v] + h3[v];
+}
+
+//16位：子直方图有65536项，只用一个
+static void count_rows_16u(const Mat& src, const Mat& mask, const Rect& roi, int begin, int end, int* hist) {
+    for (int i = begin; i < end; ++i) {
+        const ushort* p = src.ptr<ushort>(roi.y + i) + roi.x;
+        const uchar* m = mask.empty() ? nullptr : mask.ptr<uchar>(roi.y + i) + roi.x;
+        for (int j = 0; j < roi.width; ++j) {
+            if (!m || m[j]) hist[p[j]]++;
+        }
+    }
+}
+
+void calc_histogram(const Mat& src, vector<int>& hist, const Rect& roi, const Mat& mask) {
+    hist.clear();
+    if (src.type() != CV_8UC1 && src.type() != CV_16UC1) {
+        cerr << "错误: 直方图只支持CV_8UC1或CV_16UC1图像" << endl;
+        return;
+    }
+    if (!mask.empty() && (mask.type() != CV_8UC1 || mask.size() != src.size())) {
+        cerr << "错误: 掩码必须是与图像同尺寸的CV_8UC1" << endl;
+        return;
+    }
+    bool wide = src.type() == CV_16UC1;
+    int bins = wide ? 65536 : 256;
+    hist.assign(bins, 0);
+    Rect r = (roi.width > 0 && roi.height > 0) ? (roi & Rect(0, 0, src.cols, src.rows)) : Rect(0, 0, src.cols, src.rows);
+    if (r.width <= 0 || r.height <= 0) return;
+
+    //按行条带分线程，每个条带一个私有直方图，统计完再相加，结果与线程数无关
+    int stripes = (int)min<long long>((long long)r.area() / HISTOGRAM_MIN_PIXELS_PER_THREAD, getNumThreads());
+    stripes = max(1, min(stripes, r.height));
+    int lane_size = wide ? bins : HISTOGRAM_LANES * bins;
+    vector<int> partial((size_t)stripes * lane_size, 0);
+    parallel_for_(Range(0, stripes), [&](const Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            int begin = (int)((long long)r.height * s / stripes);
+            int end = (int)((long long)r.height * (s + 1) / stripes);
+            int* own = &partial[(size_t)s * lane_size];
+            if (wide) {
+                count_rows_16u(src, mask, r, begin, end, own);
+            } else {
+                count_rows_8u(src, mask, r, begin, end, own);
+            }
+        }
+    }, stripes);
+    for (int s = 0; s < stripes; ++s) {
+        const int* own = &partial[(size_t)s * lane_size];
+        for (int v = 0; v < bins; ++v) hist[v] += own[v];
+    }
+}
+
+vector<int> calc_histogram(const Mat& src, const Rect& roi, const Mat& mask) {
+    vector<int> hist;
+    calc_histogram(src, hist, roi, mask);
+    return hist;
+}
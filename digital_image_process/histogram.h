@@ -0,0 +1,18 @@
+// histogram.h
+#pragma once
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+//灰度直方图：hist[v]为灰度v的像素个数
+//src为CV_8UC1(256个灰度级)或CV_16UC1(65536个灰度级)
+//roi为空时统计整幅图像，否则只统计roi与图像相交的部分；mask为空或与src同尺寸的CV_8UC1，只统计mask非0的像素
+//大图像按行条带分给多个线程，每个线程统计自己的子直方图，最后相加；
+//8位图像每个线程再用4个交替累加的子直方图，相同灰度连续出现时不会反复读写同一个计数器
+//出错时hist为空
+void calc_histogram(const cv::Mat& src, std::vector<int>& hist,
+                    const cv::Rect& roi = cv::Rect(), const cv::Mat& mask = cv::Mat());
+
+//直方图的便捷版本
+std::vector<int> calc_histogram(const cv::Mat& src, const cv::Rect& roi = cv::Rect(),
+                                const cv::Mat& mask = cv::Mat());
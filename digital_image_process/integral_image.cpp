@@ -0,0 +1,86 @@
+//积分图：O(1)计算任意矩形区域的和、均值、方差、三阶矩
+#include "integral_image.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+IntegralImage::IntegralImage(const Mat& img, int max_order)
+    : rows_(0), cols_(0), max_order_(0) {
+    if (img.type() != CV_8UC1) {
+        cerr << "错误: 积分图只支持8位单通道灰度图" << endl;
+        return;
+    }
+    if (max_order < 1 || max_order > 3) {
+        cerr << "错误: 积分图的最高次幂必须为1~3" << endl;
+        return;
+    }
+    rows_ = img.rows;
+    cols_ = img.cols;
+    max_order_ = max_order;
+    size_t stride = cols_ + 1;
+    for (int k = 0; k < max_order_; ++k) table_[k].assign((size_t)(rows_ + 1) * stride, 0);
+
+    //逐行累加：table(y+1,x+1) = table(y,x+1) + 本行前x+1个像素之和
+    //每一阶单独扫一遍，用行指针累加，不需要的高次幂不计算
+    for (int k = 0; k < max_order_; ++k) {
+        int64* t = table_[k].data();
+        for (int y = 0; y < rows_; ++y) {
+            const uchar* p = img.ptr<uchar>(y);
+            const int64* above = t + (size_t)y * stride + 1;
+            int64* cur = t + (size_t)(y + 1) * stride + 1;
+            int64 row_sum = 0;
+            for (int x = 0; x < cols_; ++x) {
+                int64 v = p[x];
+                row_sum += k == 0 ? v : k == 1 ? v * v : v * v * v;
+                cur[x] = above[x] + row_sum;
+            }
+        }
+    }
+}
+
+Rect IntegralImage::clip(const Rect& r) const {
+    return r & Rect(0, 0, cols_, rows_);
+}
+
+int IntegralImage::count(const Rect& r) const {
+    return clip(r).area();
+}
+
+int64 IntegralImage::sum(const Rect& r, int order) const {
+    if (order < 1 || order > max_order_) {
+        cerr << "错误: 积分图只保存了1~" << max_order_ << "次幂" << endl;
+        return 0;
+    }
+    Rect c = clip(r);
+    if (c.area() <= 0) return 0;
+    const vector<int64>& t = table_[order - 1];
+    size_t stride = cols_ + 1;
+    size_t top = (size_t)c.y * stride, bottom = (size_t)(c.y + c.height) * stride;
+    return t[bottom + c.x + c.width] - t[top + c.x + c.width] - t[bottom + c.x] + t[top + c.x];
+}
+
+double IntegralImage::mean(const Rect& r) const {
+    int n = count(r);
+    return n > 0 ? (double)sum(r, 1) / n : 0.0;
+}
+
+//精确整数和上计算：n^2 * 方差 = n * S2 - S1^2
+double IntegralImage::variance(const Rect& r) const {
+    int n = count(r);
+    if (n <= 0) return 0.0;
+    int64 s1 = sum(r, 1), s2 = sum(r, 2);
+    double nn = (double)n * n;
+    return max(0.0, ((double)n * s2 - (double)s1 * s1) / nn);
+}
+
+//三阶中心矩 = S3/n - 3*m*S2/n + 2*m^3
+double IntegralImage::central_moment3(const Rect& r) const {
+    int n = count(r);
+    if (n <= 0) return 0.0;
+    double m = (double)sum(r, 1) / n;
+    double s2 = (double)sum(r, 2) / n;
+    double s3 = (double)sum(r, 3) / n;
+    return s3 - 3 * m * s2 + 2 * m * m * m;
+}
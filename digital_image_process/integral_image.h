@@ -0,0 +1,39 @@
+// integral_image.h
+#pragma once
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+//积分图(summed-area table)：预处理一次后，任意矩形区域内像素的 x、x^2、x^3 之和都只需查4个表项
+//表为 (rows+1) x (cols+1)，table(y,x) = 左上角 [0,y) x [0,x) 内的和；
+//8位图像用int64累加，结果是精确的整数，方差、三阶矩不会因为大数相减丢失精度
+class IntegralImage {
+public:
+    IntegralImage() : rows_(0), cols_(0), max_order_(0) {}
+    //img为CV_8UC1，max_order为需要的最高次幂(1~3)：均值只需1，方差需2，三阶矩需3
+    explicit IntegralImage(const cv::Mat& img, int max_order = 2);
+
+    bool empty() const { return rows_ == 0 || cols_ == 0; }
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int max_order() const { return max_order_; }
+
+    //矩形内 x^order 之和，矩形先裁剪到图像范围内(图像外视为0，与零填充一致)
+    cv::int64 sum(const cv::Rect& r, int order = 1) const;
+    //裁剪后矩形内的像素个数
+    int count(const cv::Rect& r) const;
+
+    //裁剪后矩形内的均值、方差(二阶中心矩)、三阶中心矩；矩形为空时返回0
+    double mean(const cv::Rect& r) const;
+    double variance(const cv::Rect& r) const;
+    double central_moment3(const cv::Rect& r) const;
+
+    //表的第y行(0~rows)，共cols+1项，逐像素滑动窗口时直接按列下标取值，省去每次的裁剪和检查
+    const cv::int64* row(int y, int order = 1) const { return &table_[order - 1][(size_t)y * (cols_ + 1)]; }
+
+private:
+    cv::Rect clip(const cv::Rect& r) const;
+
+    int rows_, cols_, max_order_;
+    std::vector<cv::int64> table_[3]; //table_[k]为 x^(k+1) 的积分图
+};
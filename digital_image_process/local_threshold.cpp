@@ -0,0 +1,106 @@
+//积分图上的局部阈值：Niblack、Sauvola、Bradley
+#include "local_threshold.h"
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+LocalThreshold LocalThreshold::niblack(int window, double k, LocalThresholdPolarity polarity) {
+    return LocalThreshold(LOCAL_THRESHOLD_NIBLACK, window, k, 0.0, polarity);
+}
+
+LocalThreshold LocalThreshold::sauvola(int window, double k, double dynamic_range, LocalThresholdPolarity polarity) {
+    return LocalThreshold(LOCAL_THRESHOLD_SAUVOLA, window, k, dynamic_range, polarity);
+}
+
+LocalThreshold LocalThreshold::bradley(int window, double t, LocalThresholdPolarity polarity) {
+    return LocalThreshold(LOCAL_THRESHOLD_BRADLEY, window, t, 0.0, polarity);
+}
+
+void LocalThreshold::apply(const Mat& src, Mat& dst, bool invert) const {
+    if (src.type() != CV_8UC1) {
+        cerr << "错误: 局部阈值只支持8位单通道灰度图" << endl;
+        dst = Mat();
+        return;
+    }
+    //Bradley只用均值，不需要平方和的积分图
+    IntegralImage integral(src, method_ == LOCAL_THRESHOLD_BRADLEY ? 1 : 2);
+    apply(src, integral, dst, invert);
+}
+
+void LocalThreshold::apply(const Mat& src, const IntegralImage& integral, Mat& dst, bool invert) const {
+    if (src.type() != CV_8UC1 || integral.rows() != src.rows || integral.cols() != src.cols) {
+        cerr << "错误: 局部阈值需要8位单通道灰度图及其积分图" << endl;
+        dst = Mat();
+        return;
+    }
+    bool need_variance = method_ != LOCAL_THRESHOLD_BRADLEY;
+    if (need_variance && integral.max_order() < 2) {
+        cerr << "错误: Niblack、Sauvola需要平方和的积分图(max_order >= 2)" << endl;
+        dst = Mat();
+        return;
+    }
+    int window = window_ > 0 ? window_ : (max(src.cols, src.rows) / 8) | 1;
+    int half = window / 2;
+    //LIGHT_ON_DARK时在 I' = 255 - I 上计算：I' = base + sign * I，均值同样变换，窗口和为 base * n + sign * S，
+    //标准差不变；I' > T 的是(反转后的)亮背景，对应原图的暗背景，输出时再反转一次
+    bool light_on_dark = polarity_ == LOCAL_THRESHOLD_LIGHT_ON_DARK;
+    int base = light_on_dark ? 255 : 0, sign = light_on_dark ? -1 : 1;
+    //输出 = (条件成立 ? 255 : 0) ^ flip，不用分支：随机纹理处条件的真假无规律，分支预测几乎一半会错
+    uchar flip = (invert != light_on_dark) ? 255 : 0;
+    dst.create(src.size(), CV_8UC1);
+
+    //每列窗口的左右边界(裁剪到图像内)，所有行共用
+    vector<int> x0(src.cols), x1(src.cols);
+    for (int x = 0; x < src.cols; ++x) {
+        x0[x] = max(x - half, 0);
+        x1[x] = min(x + half + 1, src.cols);
+    }
+
+    //参数先取到局部变量：输出是uchar*，否则每写一个像素编译器都要重新读成员和列边界
+    const int* cx0 = x0.data();
+    const int* cx1 = x1.data();
+    LocalThresholdMethod method = method_;
+    double k = k_, inv_r = 1.0 / dynamic_range_;
+    int cols = src.cols;
+    parallel_for_(Range(0, src.rows), [&](const Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            int y0 = max(y - half, 0), y1 = min(y + half + 1, src.rows);
+            int h = y1 - y0;
+            const int64* top1 = integral.row(y0, 1);
+            const int64* bottom1 = integral.row(y1, 1);
+            const uchar* s = src.ptr<uchar>(y);
+            uchar* d = dst.ptr<uchar>(y);
+            if (method == LOCAL_THRESHOLD_BRADLEY) {
+                //I > m * (1 - t)，两边乘以n避免除法
+                double scale = 1.0 - k;
+                for (int x = 0; x < cols; ++x) {
+                    int a = cx0[x], b = cx1[x];
+                    int n = (b - a) * h;
+                    int64 s1 = base * (int64)n + sign * (bottom1[b] - top1[b] - bottom1[a] + top1[a]);
+                    int v = base + sign * s[x];
+                    d[x] = (uchar)(-(int)((double)v * n > s1 * scale)) ^ flip;
+                }
+                continue;
+            }
+            const int64* top2 = integral.row(y0, 2);
+            const int64* bottom2 = integral.row(y1, 2);
+            for (int x = 0; x < cols; ++x) {
+                int a = cx0[x], b = cx1[x];
+                int n = (b - a) * h;
+                int64 s1 = bottom1[b] - top1[b] - bottom1[a] + top1[a];
+                int64 s2 = bottom2[b] - top2[b] - bottom2[a] + top2[a];
+                double m = (double)s1 / n;
+                //方差与IntegralImage::variance相同的整数和公式
+                double sd = sqrt(max(0.0, ((double)n * s2 - (double)s1 * s1) / ((double)n * n)));
+                m = base + sign * m;
+                double T = method == LOCAL_THRESHOLD_NIBLACK ? m + k * sd : m * (1.0 + k * (sd * inv_r - 1.0));
+                int v = base + sign * s[x];
+                d[x] = (uchar)(-(int)(v > T)) ^ flip;
+            }
+        }
+    });
+}
@@ -0,0 +1,54 @@
+// local_threshold.h
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "integral_image.h"
+
+//局部阈值的计算方法，m、s为以像素为中心的窗口内的均值、标准差
+enum LocalThresholdMethod {
+    LOCAL_THRESHOLD_NIBLACK = 0, //T = m + k * s
+    LOCAL_THRESHOLD_SAUVOLA = 1, //T = m * (1 + k * (s / R - 1))
+    LOCAL_THRESHOLD_BRADLEY = 2  //T = m * (1 - t)，只需均值
+};
+
+//前景与背景的明暗关系：局部阈值公式(尤其Sauvola)是为白纸黑字设计的
+enum LocalThresholdPolarity {
+    LOCAL_THRESHOLD_DARK_ON_LIGHT = 0, //暗前景、亮背景(文档)：按原灰度计算
+    LOCAL_THRESHOLD_LIGHT_ON_DARK = 1  //亮前景、暗背景(如车牌的白字)：按 255 - I 计算
+};
+
+//局部(自适应)阈值：每个像素用自己邻域的统计量定阈值，适合光照不均匀的文档、车牌等
+//窗口内的和、平方和由 I 和 I^2 的积分图查表得到，每个像素O(1)，与窗口大小无关；
+//窗口在图像边缘处裁剪到图像内部，只统计图像内的像素
+class LocalThreshold {
+public:
+    //window为窗口边长(奇数)，<=0时取图像宽、高中较大者的1/8 (Bradley的取法)
+    static LocalThreshold niblack(int window = 25, double k = -0.2,
+                                  LocalThresholdPolarity polarity = LOCAL_THRESHOLD_DARK_ON_LIGHT);
+    static LocalThreshold sauvola(int window = 25, double k = 0.34, double dynamic_range = 128.0,
+                                  LocalThresholdPolarity polarity = LOCAL_THRESHOLD_DARK_ON_LIGHT);
+    static LocalThreshold bradley(int window = 0, double t = 0.15,
+                                  LocalThresholdPolarity polarity = LOCAL_THRESHOLD_DARK_ON_LIGHT);
+
+    //src为CV_8UC1，一遍扫描直接输出CV_8UC1二值图，亮的一类为255、暗的一类为0 (与THRESH_BINARY一致)：
+    //DARK_ON_LIGHT时 I > T 为255；LIGHT_ON_DARK时阈值在 255 - I 上计算，亮前景为255
+    //invert为true时输出相反；行间用cv::parallel_for_并行；出错时dst为空
+    void apply(const cv::Mat& src, cv::Mat& dst, bool invert = false) const;
+    //已有积分图时直接使用，Niblack、Sauvola需要max_order >= 2
+    void apply(const cv::Mat& src, const IntegralImage& integral, cv::Mat& dst, bool invert = false) const;
+
+    LocalThresholdMethod method() const { return method_; }
+    LocalThresholdPolarity polarity() const { return polarity_; }
+    int window() const { return window_; }
+
+private:
+    LocalThreshold(LocalThresholdMethod method, int window, double k, double dynamic_range,
+                   LocalThresholdPolarity polarity)
+        : method_(method), polarity_(polarity), window_(window), k_(k), dynamic_range_(dynamic_range) {}
+
+    LocalThresholdMethod method_;
+    LocalThresholdPolarity polarity_;
+    int window_;
+    double k_;             //Niblack、Sauvola的k，Bradley的t
+    double dynamic_range_; //Sauvola的R
+};
@@ -0,0 +1,278 @@
+//中值滤波：排序网络(3x3、5x5)与O(1)的列直方图滑动中值
+#include "median_filter.h"
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MEDIAN_HAVE_SSE2 1
+#endif
+
+using namespace std;
+using namespace cv;
+
+//---------------- 边界扩展 ----------------
+
+//按边界策略扩展后，每个窗口都是扩展图像中的一个矩形，取中值时不再判断越界
+//BORDER_MODE_IGNORE的边界像素最后清零，扩展方式无所谓
+template<typename T>
+static void pad_for_median(const T* src, int width, int height, int m_width, int m_height,
+                           BorderMode border, vector<T>& padded) {
+    if (border == BORDER_MODE_IGNORE) border = BORDER_MODE_REPLICATE;
+    dispatch_border(border, [&](auto policy) {
+        pad_image<decltype(policy)>(src, width, height, m_width, m_height, padded);
+    });
+}
+
+//---------------- 排序网络 ----------------
+
+template<typename T>
+static inline void sort2(T& a, T& b) {
+    T lo = min(a, b);
+    b = max(a, b);
+    a = lo;
+}
+
+//网络中的每个“元素”是一段MEDIAN_SPAN个像素：同一次比较交换同时作用于一行中的多个输出像素，
+//x86上用SSE2一次处理16个uchar或2个double；一行最后不足一段时多算的部分不写出
+const int MEDIAN_SPAN = 256;
+
+template<typename T>
+struct PixelSpan {
+    T* data;
+};
+
+template<typename T>
+static inline void sort2_span(T* a, T* b) {
+    for (int j = 0; j < MEDIAN_SPAN; ++j) {
+        T x = a[j], y = b[j];
+        a[j] = min(x, y);
+        b[j] = max(x, y);
+    }
+}
+
+#ifdef MEDIAN_HAVE_SSE2
+template<>
+inline void sort2_span<uchar>(uchar* a, uchar* b) {
+    for (int j = 0; j < MEDIAN_SPAN; j += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + j));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a + j), _mm_min_epu8(x, y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(b + j), _mm_max_epu8(x, y));
+    }
+}
+
+template<>
+inline void sort2_span<double>(double* a, double* b) {
+    for (int j = 0; j < MEDIAN_SPAN; j += 2) {
+        __m128d x = _mm_loadu_pd(a + j);
+        __m128d y = _mm_loadu_pd(b + j);
+        _mm_storeu_pd(a + j, _mm_min_pd(x, y));
+        _mm_storeu_pd(b + j, _mm_max_pd(x, y));
+    }
+}
+#endif
+
+template<typename T>
+static inline void sort2(PixelSpan<T>& a, PixelSpan<T>& b) {
+    sort2_span(a.data, b.data);
+}
+
+//9个数的中值，19次比较交换
+template<typename T>
+static inline T median9(T* p) {
+    sort2(p[1], p[2]); sort2(p[4], p[5]); sort2(p[7], p[8]);
+    sort2(p[0], p[1]); sort2(p[3], p[4]); sort2(p[6], p[7]);
+    sort2(p[1], p[2]); sort2(p[4], p[5]); sort2(p[7], p[8]);
+    sort2(p[0], p[3]); sort2(p[5], p[8]); sort2(p[4], p[7]);
+    sort2(p[3], p[6]); sort2(p[1], p[4]); sort2(p[2], p[5]);
+    sort2(p[4], p[7]); sort2(p[4], p[2]); sort2(p[6], p[4]);
+    sort2(p[4], p[2]);
+    return p[4];
+}
+
+//25个数的中值，99次比较交换
+template<typename T>
+static inline T median25(T* p) {
+    sort2(p[0], p[1]);   sort2(p[3], p[4]);   sort2(p[2], p[4]);
+    sort2(p[2], p[3]);   sort2(p[6], p[7]);   sort2(p[5], p[7]);
+    sort2(p[5], p[6]);   sort2(p[9], p[10]);  sort2(p[8], p[10]);
+    sort2(p[8], p[9]);   sort2(p[12], p[13]); sort2(p[11], p[13]);
+    sort2(p[11], p[12]); sort2(p[15], p[16]); sort2(p[14], p[16]);
+    sort2(p[14], p[15]); sort2(p[18], p[19]); sort2(p[17], p[19]);
+    sort2(p[17], p[18]); sort2(p[21], p[22]); sort2(p[20], p[22]);
+    sort2(p[20], p[21]); sort2(p[23], p[24]); sort2(p[2], p[5]);
+    sort2(p[3], p[6]);   sort2(p[0], p[6]);   sort2(p[0], p[3]);
+    sort2(p[4], p[7]);   sort2(p[1], p[7]);   sort2(p[1], p[4]);
+    sort2(p[11], p[14]); sort2(p[8], p[14]);  sort2(p[8], p[11]);
+    sort2(p[12], p[15]); sort2(p[9], p[15]);  sort2(p[9], p[12]);
+    sort2(p[13], p[16]); sort2(p[10], p[16]); sort2(p[10], p[13]);
+    sort2(p[20], p[23]); sort2(p[17], p[23]); sort2(p[17], p[20]);
+    sort2(p[21], p[24]); sort2(p[18], p[24]); sort2(p[18], p[21]);
+    sort2(p[19], p[22]); sort2(p[8], p[17]);  sort2(p[9], p[18]);
+    sort2(p[0], p[18]);  sort2(p[0], p[9]);   sort2(p[10], p[19]);
+    sort2(p[1], p[19]);  sort2(p[1], p[10]);  sort2(p[11], p[20]);
+    sort2(p[2], p[20]);  sort2(p[2], p[11]);  sort2(p[12], p[21]);
+    sort2(p[3], p[21]);  sort2(p[3], p[12]);  sort2(p[13], p[22]);
+    sort2(p[4], p[22]);  sort2(p[4], p[13]);  sort2(p[14], p[23]);
+    sort2(p[5], p[23]);  sort2(p[5], p[14]);  sort2(p[15], p[24]);
+    sort2(p[6], p[24]);  sort2(p[6], p[15]);  sort2(p[7], p[16]);
+    sort2(p[7], p[19]);  sort2(p[13], p[21]); sort2(p[15], p[23]);
+    sort2(p[7], p[13]);  sort2(p[7], p[15]);  sort2(p[1], p[9]);
+    sort2(p[3], p[11]);  sort2(p[5], p[17]);  sort2(p[11], p[17]);
+    sort2(p[9], p[17]);  sort2(p[4], p[10]);  sort2(p[6], p[12]);
+    sort2(p[7], p[14]);  sort2(p[4], p[6]);   sort2(p[4], p[7]);
+    sort2(p[12], p[14]); sort2(p[10], p[14]); sort2(p[6], p[7]);
+    sort2(p[10], p[12]); sort2(p[6], p[10]);  sort2(p[6], p[17]);
+    sort2(p[12], p[17]); sort2(p[7], p[17]);  sort2(p[7], p[10]);
+    sort2(p[12], p[18]); sort2(p[7], p[12]);  sort2(p[10], p[18]);
+    sort2(p[12], p[20]); sort2(p[10], p[20]); sort2(p[10], p[12]);
+    return p[12];
+}
+
+//在扩展图像上取出窗口：3x3、5x5按每段MEDIAN_SPAN个输出像素装入9/25段缓冲区后走排序网络，
+//其他尺寸逐点用nth_element (缓冲区只分配一次)
+
+template<typename T>
+static void median_select(const T* padded, T* dst, int width, int height, int m_width, int m_height) {
+    int pw = width + m_width - 1;
+    int size = m_width * m_height;
+    bool network = (m_width == 3 && m_height == 3) || (m_width == 5 && m_height == 5);
+    if (network) {
+        vector<T> buffer((size_t)size * MEDIAN_SPAN);
+        vector<PixelSpan<T> > spans(size);
+        for (int i = 0; i < height; ++i) {
+            for (int j0 = 0; j0 < width; j0 += MEDIAN_SPAN) {
+                int n = min(MEDIAN_SPAN, width - j0);
+                for (int k = 0; k < size; ++k) {
+                    const T* s = padded + (size_t)(i + k / m_width) * pw + j0 + k % m_width;
+                    spans[k].data = &buffer[(size_t)k * MEDIAN_SPAN];
+                    copy(s, s + n, spans[k].data);
+                }
+                PixelSpan<T> median = (size == 9) ? median9(spans.data()) : median25(spans.data());
+                copy(median.data, median.data + n, dst + (size_t)i * width + j0);
+            }
+        }
+        return;
+    }
+    vector<T> window(size);
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            T* w = window.data();
+            for (int n = 0; n < m_height; ++n) {
+                const T* s = padded + (size_t)(i + n) * pw + j;
+                for (int m = 0; m < m_width; ++m) *w++ = s[m];
+            }
+            nth_element(window.begin(), window.begin() + size / 2, window.end());
+            dst[(size_t)i * width + j] = window[size / 2];
+        }
+    }
+}
+
+//---------------- 列直方图滑动中值 (8位) ----------------
+
+//每列保存当前窗口高度内的粗直方图(16个分箱，按高4位)和细直方图(256个分箱)；
+//窗口直方图的粗分箱每移动一列更新一次，细分箱只在中值落入该粗分箱时才补上落后的列
+static void median_histogram(const uchar* padded, uchar* dst, int width, int height,
+                             int m_width, int m_height) {
+    int pw = width + m_width - 1;
+    int rank = m_width * m_height / 2;
+    vector<int> col_coarse((size_t)pw * 16, 0), col_fine((size_t)pw * 256, 0);
+    auto add_row = [&](int y, int delta) {
+        const uchar* s = padded + (size_t)y * pw;
+        for (int x = 0; x < pw; ++x) {
+            col_coarse[(size_t)x * 16 + (s[x] >> 4)] += delta;
+            col_fine[(size_t)x * 256 + s[x]] += delta;
+        }
+    };
+    for (int y = 0; y < m_height - 1; ++y) add_row(y, 1);
+
+    int coarse[16], fine[256], updated[16];
+    for (int i = 0; i < height; ++i) {
+        add_row(i + m_height - 1, 1);
+        if (i > 0) add_row(i - 1, -1);
+
+        fill(coarse, coarse + 16, 0);
+        for (int x = 0; x < m_width; ++x) {
+            const int* c = &col_coarse[(size_t)x * 16];
+            for (int k = 0; k < 16; ++k) coarse[k] += c[k];
+        }
+        fill(updated, updated + 16, -1); //细分箱k对应的窗口左边界，-1表示需要重建
+
+        for (int j = 0; j < width; ++j) {
+            if (j > 0) {
+                const int* out = &col_coarse[(size_t)(j - 1) * 16];
+                const int* in = &col_coarse[(size_t)(j + m_width - 1) * 16];
+                for (int k = 0; k < 16; ++k) coarse[k] += in[k] - out[k];
+            }
+            int sum = 0, k = 0;
+            while (sum + coarse[k] <= rank) sum += coarse[k++];
+
+            int* f = fine + k * 16;
+            if (updated[k] < 0 || j - updated[k] >= m_width) {
+                fill(f, f + 16, 0);
+                for (int x = j; x < j + m_width; ++x) {
+                    const int* c = &col_fine[(size_t)x * 256 + k * 16];
+                    for (int b = 0; b < 16; ++b) f[b] += c[b];
+                }
+            } else {
+                for (int x = updated[k]; x < j; ++x) {
+                    const int* out = &col_fine[(size_t)x * 256 + k * 16];
+                    const int* in = &col_fine[(size_t)(x + m_width) * 256 + k * 16];
+                    for (int b = 0; b < 16; ++b) f[b] += in[b] - out[b];
+                }
+            }
+            updated[k] = j;
+
+            int b = 0;
+            while (sum + f[b] <= rank) sum += f[b++];
+            dst[(size_t)i * width + j] = (uchar)(k * 16 + b);
+        }
+    }
+}
+
+//---------------- 对外接口 ----------------
+
+void median_filter(const uchar* src, uchar* dst, int width, int height,
+                   int m_width, int m_height, BorderMode border) {
+    if (width <= 0 || height <= 0 || m_width <= 0 || m_height <= 0) return;
+    vector<uchar> padded;
+    pad_for_median(src, width, height, m_width, m_height, border, padded);
+    if ((m_width == 3 && m_height == 3) || (m_width == 5 && m_height == 5)) {
+        median_select(padded.data(), dst, width, height, m_width, m_height);
+    } else {
+        median_histogram(padded.data(), dst, width, height, m_width, m_height);
+    }
+    if (border == BORDER_MODE_IGNORE) clear_ignored_border(dst, width, height, m_width, m_height);
+}
+
+void median_filter(const double* src, double* dst, int width, int height,
+                   int m_width, int m_height, BorderMode border) {
+    if (width <= 0 || height <= 0 || m_width <= 0 || m_height <= 0) return;
+    size_t total = (size_t)width * height;
+    bool is_8bit = all_of(src, src + total, [](double v) { return v >= 0 && v <= 255 && v == floor(v); });
+    if (is_8bit) {
+        vector<uchar> src_8u(total), dst_8u(total);
+        for (size_t k = 0; k < total; ++k) src_8u[k] = (uchar)src[k];
+        median_filter(src_8u.data(), dst_8u.data(), width, height, m_width, m_height, border);
+        for (size_t k = 0; k < total; ++k) dst[k] = dst_8u[k];
+        return;
+    }
+    vector<double> padded;
+    pad_for_median(src, width, height, m_width, m_height, border, padded);
+    median_select(padded.data(), dst, width, height, m_width, m_height);
+    if (border == BORDER_MODE_IGNORE) clear_ignored_border(dst, width, height, m_width, m_height);
+}
+
+void median_filter(const Mat& src, Mat& dst, int m_width, int m_height, BorderMode border) {
+    if (src.type() != CV_8UC1) {
+        cerr << "错误: 中值滤波只支持8位单通道灰度图" << endl;
+        dst = Mat();
+        return;
+    }
+    Mat input = src.isContinuous() ? src : src.clone();
+    Mat result(src.size(), CV_8UC1);
+    median_filter(input.ptr<uchar>(), result.ptr<uchar>(), src.cols, src.rows, m_width, m_height, border);
+    dst = result;
+}
@@ -0,0 +1,21 @@
+// median_filter.h
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "border.h"
+
+//中值滤波：dst(i,j) = 窗口 [i - m_height/2, ...) x [j - m_width/2, ...) 内排序后第 m_width*m_height/2 个值
+//(与排序后取sort_arr[mask_size/2]相同)，边界按border处理(零填充、复制、镜像、周期延拓或忽略)
+//  3x3、5x5 用固定的排序网络(19次、99次比较交换)，一次作用于一整段输出像素，无分支
+//  其他尺寸的8位图像用Perreault-Hebert的列直方图算法：每列保存窗口高度内的直方图，
+//  窗口右移时只加一列、减一列(16个粗分箱)，细分箱按需更新，每个像素O(1)，与窗口半径无关
+void median_filter(const uchar* src, uchar* dst, int width, int height,
+                   int m_width, int m_height, BorderMode border = BORDER_MODE_REPLICATE);
+
+//double版本：像素全部是0~255的整数时转为8位计算(结果完全相同)，否则用排序网络或nth_element
+void median_filter(const double* src, double* dst, int width, int height,
+                   int m_width, int m_height, BorderMode border = BORDER_MODE_REPLICATE);
+
+//Mat版本：src为CV_8UC1
+void median_filter(const cv::Mat& src, cv::Mat& dst, int m_width, int m_height,
+                   BorderMode border = BORDER_MODE_REPLICATE);
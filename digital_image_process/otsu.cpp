@@ -7,7 +7,10 @@
 #include <iostream>
 #include <vector>
 #include <numeric> 
+#include <algorithm>
 #include <opencv2/opencv.hpp>
+#include "otsu.h"
+#include "histogram.h"
 using namespace std;
 using namespace cv;
 
@@ -19,37 +22,31 @@ int otsu_threshold(const Mat& img_gray) {
     }
     //计算图像的直方图
     //hist[i]存储灰度值为i的像素个数
-    vector<int> hist(256, 0);
-    for (int i = 0; i < img_gray.rows; ++i) {
-        for (int j = 0; j < img_gray.cols; ++j) {
-            hist[img_gray.at<uchar>(i, j)]++;
-        }
+    vector<int> hist = calc_histogram(img_gray);
+    return otsu_threshold(hist);
+}
+
+int otsu_threshold(const vector<int>& hist) {
+    //计算总像素数和总灰度和
+    long total_pixels = 0;
+    double total_sum = 0;
+    for (size_t i = 0; i < hist.size(); ++i) {
+        total_pixels += hist[i];
+        total_sum += (double)i * hist[i];
     }
     
-    //计算总像素数
-    long total_pixels = img_gray.rows * img_gray.cols;
-    
     //用于存储遍历过程中的最大类间方差和对应的最佳阈值
     double max_variance = 0.0;
     int best_threshold = 0;
 
-    for (int t = 0; t < 256; ++t) {
-        //对每个阈值t,计算类间方差
-        long w0_count = 0; //背景像素总数
-        long w1_count = 0; //前景像素总数
-        double w0_sum = 0;       //背景像素灰度总和
-        double w1_sum = 0;       //前景像素灰度总和
-
-        //根据阈值t，将像素分为背景(<=t)和前景(>t)两组
-        for (int i = 0; i < 256; ++i) {
-            if (i <= t) {
-                w0_count += hist[i];
-                w0_sum += i * hist[i];
-            } else {
-                w1_count += hist[i];
-                w1_sum += i * hist[i];
-            }
-        }
+    //阈值t从小到大，背景(<=t)的像素数、灰度和只需加上第t级，前景(>t)由总数减去背景得到
+    long w0_count = 0; //背景像素总数
+    double w0_sum = 0; //背景像素灰度总和
+    for (int t = 0; t < (int)hist.size(); ++t) {
+        w0_count += hist[t];
+        w0_sum += (double)t * hist[t];
+        long w1_count = total_pixels - w0_count; //前景像素总数
+        double w1_sum = total_sum - w0_sum;      //前景像素灰度总和
 
         if (w0_count == 0 || w1_count == 0) {
             continue; 
@@ -61,7 +58,7 @@ int otsu_threshold(const Mat& img_gray) {
         double u0 = w0_sum / w0_count;
         double u1 = w1_sum / w1_count;
         //计算类间方差 g
-        double variance = w0 * w1 * pow(u0 - u1, 2);
+        double variance = w0 * w1 * (u0 - u1) * (u0 - u1);
         //更新最大方差和最佳阈值
         if (variance > max_variance) {
             max_variance = variance;
@@ -70,3 +67,72 @@ int otsu_threshold(const Mat& img_gray) {
     }
     return best_threshold;
 }
+
+vector<int> otsu_multi_threshold(const Mat& img_gray, int count) {
+    if (img_gray.type() != CV_8UC1) {
+        cout << "错误: 输入图像必须是8位单通道灰度图" << endl;
+        return vector<int>();
+    }
+    return otsu_multi_threshold(calc_histogram(img_gray), count);
+}
+
+//类间方差 = sum(S_k^2 / P_k) - S^2 / N，其中P_k、S_k为第k类的像素数、灰度和
+//后一项与阈值无关，只需最大化第一项；每一类的 S_k^2 / P_k 由累积表两项相减得到
+//动态规划的最大灰度级数，超过时先合并区间
+const int OTSU_MULTI_MAX_LEVELS = 256;
+
+vector<int> otsu_multi_threshold(const vector<int>& hist, int count) {
+    int levels = (int)hist.size();
+    if (levels > OTSU_MULTI_MAX_LEVELS) {
+        //合并成等宽区间：类间方差对灰度的线性变换不变，用区间序号代替区间内的灰度即可
+        int bin_width = (levels + OTSU_MULTI_MAX_LEVELS - 1) / OTSU_MULTI_MAX_LEVELS;
+        vector<int> coarse((levels + bin_width - 1) / bin_width, 0);
+        for (int i = 0; i < levels; ++i) coarse[i / bin_width] += hist[i];
+        vector<int> thresholds = otsu_multi_threshold(coarse, count);
+        for (int& t : thresholds) t = min((t + 1) * bin_width - 1, levels - 1);
+        return thresholds;
+    }
+    if (count < 1 || count >= levels) {
+        cout << "错误: 阈值个数必须在1到灰度级数-1之间" << endl;
+        return vector<int>();
+    }
+    //P[t]、S[t]为灰度 < t 的像素数、灰度和
+    vector<double> P(levels + 1, 0.0), S(levels + 1, 0.0);
+    for (int i = 0; i < levels; ++i) {
+        P[i + 1] = P[i] + hist[i];
+        S[i + 1] = S[i] + (double)i * hist[i];
+    }
+    //灰度在[a, b]内的一类对目标的贡献，空类为0
+    auto term = [&](int a, int b) {
+        double p = P[b + 1] - P[a];
+        double s = S[b + 1] - S[a];
+        return p > 0 ? s * s / p : 0.0;
+    };
+
+    //best[k][t]：灰度[0, t]分成k+1类的最大值，arg[k][t]为其中第k个阈值(第k类的最后一个灰度)
+    vector<vector<double>> best(count + 1, vector<double>(levels, 0.0));
+    vector<vector<int>> arg(count + 1, vector<int>(levels, 0));
+    for (int t = 0; t < levels; ++t) best[0][t] = term(0, t);
+    for (int k = 1; k <= count; ++k) {
+        for (int t = k; t < levels; ++t) {
+            double max_value = -1.0;
+            for (int s = k - 1; s < t; ++s) {
+                double value = best[k - 1][s] + term(s + 1, t);
+                if (value > max_value) {
+                    max_value = value;
+                    arg[k][t] = s;
+                }
+            }
+            best[k][t] = max_value;
+        }
+    }
+
+    //从最后一类向前回溯阈值
+    vector<int> thresholds(count);
+    int t = levels - 1;
+    for (int k = count; k >= 1; --k) {
+        t = arg[k][t];
+        thresholds[k - 1] = t;
+    }
+    return thresholds;
+}
@@ -1,9 +1,22 @@
 // otsu.h
 #pragma once 
 
+#include <vector>
 #include <opencv2/opencv.hpp>
 
 //手写实现大津法(Otsu's Method)来寻找最佳阈值
 //param img_gray 输入的单通道8位灰度图 (CV_8U)
 //return计算出的最佳阈值
-int otsu_threshold(const cv::Mat& img_gray);
\ No newline at end of file
+int otsu_threshold(const cv::Mat& img_gray);
+
+//由已有的直方图计算大津阈值，不再扫描像素；hist可以是任意灰度级数(如16位图像的65536级)
+//累积像素数、累积灰度和一遍扫描，O(L)
+int otsu_threshold(const std::vector<int>& hist);
+
+//多阈值大津法：把灰度分成 count+1 类，使类间方差最大(多相材料分割一般count为2~4)
+//return递增的count个阈值 t1 < t2 < ...，第k类为 (t_{k-1}, t_k]；出错时返回空
+//在累积表上做动态规划，O(count * L^2)时间、O(count * L)内存，L最多256：
+//直方图超过256级(如16位图像)时先合并成256个等宽的区间再计算，阈值为所在区间的最后一个灰度，
+//精度为区间宽度(16位图像为256个灰度级)
+std::vector<int> otsu_multi_threshold(const cv::Mat& img_gray, int count);
+std::vector<int> otsu_multi_threshold(const std::vector<int>& hist, int count);
@@ -0,0 +1,48 @@
+// point_transform.h
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <opencv2/opencv.hpp>
+
+//8位图像的逐点灰度变换 s = T(r)：输出只取决于输入的灰度，预先算好256项查找表，
+//每个像素只查一次表，不需要逐像素调用log、pow或分支
+class PointTransform {
+public:
+    //恒等变换
+    PointTransform();
+    //由 s = f(r) 建立查找表，结果四舍五入(最近偶数，同saturate_cast)并饱和到0-255
+    explicit PointTransform(const std::function<double(int)>& f);
+
+    //由 f 建立查找表，并把图像中出现的灰度(hist[r] > 0)上f的最小、最大值归一化到0-255，
+    //与逐像素计算f、normalize(NORM_MINMAX)、convertTo(CV_8U)的结果完全相同：
+    //归一化只用到图像中f的最小、最大值，由直方图直接在256项内求出即可
+    static PointTransform normalized(const std::function<double(int)>& f, const std::vector<int>& hist);
+    //同上，但按[r_min, r_max]内的所有灰度求f的最小、最大值，不需要直方图；
+    //只有f单调(如log、gamma)时极值才一定在r_min、r_max处取得，这时与上面的结果相同，
+    //f不单调时图像中没有出现的中间灰度可能成为极值，应使用直方图版本
+    static PointTransform normalized(const std::function<double(int)>& f, int r_min, int r_max);
+
+    //图像反转 s = 255 - r
+    static PointTransform inverse();
+    //对数变换 s = c * log(1 + r)，按图像灰度范围[r_min, r_max]归一化
+    static PointTransform log(double c, int r_min, int r_max);
+    //伽马变换 s = c * r^gamma，按图像灰度范围[r_min, r_max]归一化
+    static PointTransform gamma(double c, double gamma, int r_min, int r_max);
+    //对比度拉伸：[a, b]线性拉伸到[0, 255]，b <= a时为恒等变换
+    static PointTransform contrast_stretch(int a, int b);
+    //灰度级分层：[lower, upper]内设为highlight，其余保留原值或置0
+    static PointTransform slice(int lower, int upper, int highlight, bool keep_background);
+    //比特平面：第bit位(1~8)为1时255，否则0
+    static PointTransform bit_plane(int bit);
+
+    uchar operator[](int r) const { return table_[r]; }
+    const uchar* table() const { return table_; }
+
+    //src为任意通道数的8位图像，每个字节独立查表；dst尺寸、类型正确时直接写入(可以与src相同)
+    //支持AVX2时用VPSHUFB每次查64个字节，否则每次取8个字节查表后拼成64位一次写出；行间用cv::parallel_for_并行
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+
+private:
+    uchar table_[256];
+};
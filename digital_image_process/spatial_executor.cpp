@@ -0,0 +1,157 @@
+//空间滤波的分块多线程执行
+#include "spatial_executor.h"
+#include "median_filter.h"
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+//---------------- 常用滤波器 ----------------
+
+void ConvolutionSpatialFilter::apply(const Mat& src, Mat& dst) const {
+    convolve(src, dst, mask_, BORDER_MODE_ZERO, method_);
+}
+
+//块边缘的结果反正要丢弃，按BORDER_MODE_IGNORE只算内部，省掉逐点的边界计算
+void FixedPointSpatialFilter::apply(const Mat& src, Mat& dst) const {
+    convolve_8u(src, dst, mask_, BORDER_MODE_IGNORE, absolute_);
+}
+
+void MedianSpatialFilter::apply(const Mat& src, Mat& dst) const {
+    if (src.type() == CV_8UC1) {
+        median_filter(src, dst, size_.width, size_.height, BORDER_MODE_REPLICATE);
+        return;
+    }
+    if (src.type() != CV_64FC1) {
+        cerr << "错误: 中值滤波只支持CV_8UC1或CV_64FC1" << endl;
+        dst = Mat();
+        return;
+    }
+    Mat input = src.isContinuous() ? src : src.clone();
+    dst.create(src.size(), CV_64FC1);
+    median_filter(input.ptr<double>(), dst.ptr<double>(), src.cols, src.rows,
+                  size_.width, size_.height, BORDER_MODE_REPLICATE);
+}
+
+void BoxSpatialFilter::apply(const Mat& src, Mat& dst) const {
+    Mat input = src.isContinuous() ? src : src.clone();
+    dst.create(src.size(), CV_64FC1);
+    convolve_box(input.ptr<double>(), dst.ptr<double>(), src.cols, src.rows,
+                 size_.width, size_.height, value_, BORDER_MODE_ZERO);
+}
+
+void SeparableSpatialFilter::apply(const Mat& src, Mat& dst) const {
+    Mat input = src.isContinuous() ? src : src.clone();
+    dst.create(src.size(), CV_64FC1);
+    convolve_separable(input.ptr<double>(), dst.ptr<double>(), kernel_x_.data(), (int)kernel_x_.size(),
+                       kernel_y_.data(), (int)kernel_y_.size(), src.cols, src.rows, BORDER_MODE_ZERO);
+}
+
+//---------------- 分块 ----------------
+
+Size default_tile_size(Size kernel_size, size_t src_elem_size, size_t dst_elem_size) {
+    //(t + m - 1)^2 * (输入 + 输出) <= L2 / 2
+    double side = sqrt((double)SPATIAL_L2_BYTES / 2 / (src_elem_size + dst_elem_size));
+    int halo = max(kernel_size.width, kernel_size.height) - 1;
+    int t = max((int)side - halo, max(32, 4 * halo)); //邻域太大时块也要足够大，否则大部分计算都浪费在halo上
+    return Size(t, t);
+}
+
+//取出rect区域(可以超出图像)，图像外的像素按border填充
+static void copy_block(const Mat& src, const Rect& rect, BorderMode border, Mat& block) {
+    block.create(rect.height, rect.width, src.type());
+    size_t es = src.elemSize();
+    if (border == BORDER_MODE_IGNORE) border = BORDER_MODE_REPLICATE; //边界最后清零，扩展方式无所谓
+    dispatch_border(border, [&](auto policy) {
+        typedef decltype(policy) Border;
+        int x0 = max(0, -rect.x);
+        int x1 = max(x0, min(rect.width, src.cols - rect.x));
+        vector<int> cols(rect.width);
+        for (int x = 0; x < rect.width; ++x) cols[x] = Border::map(rect.x + x, src.cols);
+        for (int y = 0; y < rect.height; ++y) {
+            uchar* d = block.ptr<uchar>(y);
+            int sy = Border::map(rect.y + y, src.rows);
+            if (sy < 0) {
+                memset(d, 0, rect.width * es);
+                continue;
+            }
+            const uchar* s = src.ptr<uchar>(sy);
+            //图像内的部分整段复制，两侧越界的像素逐个按border取
+            memcpy(d + x0 * es, s + (rect.x + x0) * es, (x1 - x0) * es);
+            auto fill_border = [&](int x) {
+                if (cols[x] < 0) {
+                    memset(d + x * es, 0, es);
+                } else {
+                    memcpy(d + x * es, s + cols[x] * es, es);
+                }
+            };
+            for (int x = 0; x < x0; ++x) fill_border(x);
+            for (int x = x1; x < rect.width; ++x) fill_border(x);
+        }
+    });
+}
+
+//视图最后一个像素之后的地址，判断两个Mat是否共用内存
+static const uchar* mat_end(const Mat& m) {
+    return m.data + (size_t)(m.rows - 1) * (size_t)m.step + m.cols * m.elemSize();
+}
+
+void run_tiled(const SpatialFilter& filter, const Mat& src_in, Mat& dst, BorderMode border, Size tile) {
+    if (src_in.empty()) {
+        dst = Mat();
+        return;
+    }
+    //原地滤波：dst.create不会重新分配，各块写出的结果与其他块读取的邻域重叠，先复制一份输入
+    bool overlap = !dst.empty() && src_in.data < mat_end(dst) && dst.data < mat_end(src_in);
+    Mat src = overlap ? src_in.clone() : src_in;
+    Size k = filter.kernel_size();
+    int top = k.height / 2, left = k.width / 2;
+    int bottom = k.height - 1 - top, right = k.width - 1 - left;
+    int type = filter.dst_type(src.type());
+    dst.create(src.size(), type);
+    if (tile.width <= 0 || tile.height <= 0) {
+        tile = default_tile_size(k, src.elemSize(), CV_ELEM_SIZE(type));
+    }
+    int tiles_x = (src.cols + tile.width - 1) / tile.width;
+    int tiles_y = (src.rows + tile.height - 1) / tile.height;
+    int tiles = tiles_x * tiles_y;
+
+    parallel_for_(Range(0, tiles), [&](const Range& range) {
+        //每个线程的输入块、输出块缓冲区，只在尺寸变大时重新分配
+        static thread_local Mat block, result;
+        for (int t = range.start; t < range.end; ++t) {
+            int x0 = (t % tiles_x) * tile.width;
+            int y0 = (t / tiles_x) * tile.height;
+            Rect out(x0, y0, min(tile.width, src.cols - x0), min(tile.height, src.rows - y0));
+            Rect in(out.x - left, out.y - top, out.width + left + right, out.height + top + bottom);
+            copy_block(src, in, border, block);
+            filter.apply(block, result);
+            if (result.size() != block.size() || result.type() != type) {
+                cerr << "错误: 滤波器输出的尺寸或类型不正确" << endl;
+                continue;
+            }
+            Mat target = dst(out);
+            result(Rect(left, top, out.width, out.height)).copyTo(target);
+        }
+    }, tiles);
+
+    //BORDER_MODE_IGNORE：模板超出图像的位置置0 (与clear_ignored_border相同的条件)
+    if (border == BORDER_MODE_IGNORE) {
+        int ch = k.height / 2, cw = k.width / 2;
+        for (int i = 0; i < dst.rows; ++i) {
+            uchar* d = dst.ptr<uchar>(i);
+            size_t es = dst.elemSize();
+            if (i - ch < 0 || i + ch >= dst.rows) {
+                memset(d, 0, dst.cols * es);
+                continue;
+            }
+            for (int j = 0; j < dst.cols; ++j) {
+                if (j - cw < 0 || j + cw >= dst.cols) memset(d + j * es, 0, es);
+            }
+        }
+    }
+}
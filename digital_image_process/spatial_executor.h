@@ -0,0 +1,89 @@
+// spatial_executor.h
+#pragma once
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "border.h"
+#include "convolution.h"
+#include "fixed_point_convolution.h"
+
+//可以分块执行的空间滤波器：输出(i,j)只依赖以(i,j)为中心、kernel_size()大小的邻域
+//滤波器只需实现对一整块输入的滤波，分块、边界扩展和多线程都由run_tiled完成
+class SpatialFilter {
+public:
+    virtual ~SpatialFilter() {}
+    virtual cv::Size kernel_size() const = 0;
+    virtual int dst_type(int src_type) const { return src_type; }
+    //src为带邻域(halo)的输入块，dst与src同尺寸；块边缘的结果会被丢弃，按什么边界计算都可以
+    virtual void apply(const cv::Mat& src, cv::Mat& dst) const = 0;
+};
+
+//double卷积 (CV_8UC1或CV_64FC1输入，CV_64FC1输出)，每块内部仍按method选择计算方式
+class ConvolutionSpatialFilter : public SpatialFilter {
+public:
+    ConvolutionSpatialFilter(const cv::Mat& mask, ConvMethod method = CONV_AUTO) : mask_(mask), method_(method) {}
+    cv::Size kernel_size() const { return mask_.size(); }
+    int dst_type(int) const { return CV_64FC1; }
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+private:
+    cv::Mat mask_;
+    ConvMethod method_;
+};
+
+//8位定点卷积 (CV_8UC1输入输出)
+class FixedPointSpatialFilter : public SpatialFilter {
+public:
+    FixedPointSpatialFilter(const FixedPointMask& mask, bool absolute = false) : mask_(mask), absolute_(absolute) {}
+    cv::Size kernel_size() const { return cv::Size(mask_.m_width, mask_.m_height); }
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+private:
+    FixedPointMask mask_;
+    bool absolute_;
+};
+
+//中值滤波 (CV_8UC1或CV_64FC1)
+class MedianSpatialFilter : public SpatialFilter {
+public:
+    MedianSpatialFilter(int m_width, int m_height) : size_(m_width, m_height) {}
+    cv::Size kernel_size() const { return size_; }
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+private:
+    cv::Size size_;
+};
+
+//盒子滤波 (CV_64FC1)：模板所有元素都等于value，见convolve_box
+class BoxSpatialFilter : public SpatialFilter {
+public:
+    BoxSpatialFilter(int m_width, int m_height, double value) : size_(m_width, m_height), value_(value) {}
+    cv::Size kernel_size() const { return size_; }
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+private:
+    cv::Size size_;
+    double value_;
+};
+
+//可分离模板的卷积 (CV_64FC1)：kernel_x为水平方向，kernel_y为竖直方向，见convolve_separable
+class SeparableSpatialFilter : public SpatialFilter {
+public:
+    SeparableSpatialFilter(const std::vector<double>& kernel_x, const std::vector<double>& kernel_y)
+        : kernel_x_(kernel_x), kernel_y_(kernel_y) {}
+    cv::Size kernel_size() const { return cv::Size((int)kernel_x_.size(), (int)kernel_y_.size()); }
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+private:
+    std::vector<double> kernel_x_, kernel_y_;
+};
+
+//每块的输入(含halo)和输出大约占L2缓存的一半
+const size_t SPATIAL_L2_BYTES = 256 * 1024;
+
+//按模板尺寸和每个像素的输入、输出字节数估算分块尺寸
+cv::Size default_tile_size(cv::Size kernel_size, size_t src_elem_size, size_t dst_elem_size);
+
+//分块多线程执行空间滤波：
+//  1. 把图像切成tile大小的块(默认default_tile_size)，每块四周按border多取模板半径的邻域
+//  2. 每块作为cv::parallel_for_的一个条带，空闲的线程依次领取下一块，块的耗时不均匀时也能保持负载均衡
+//  3. 每块的结果只写入dst中对应的区域；dst尺寸、类型已经正确时直接写入，不重新分配
+//每块的计算互不依赖，结果与线程数无关
+//dst与src共用内存(原地滤波)时，一个块写出的结果会是其他块还要读的邻域，这时先复制src再计算
+void run_tiled(const SpatialFilter& filter, const cv::Mat& src, cv::Mat& dst,
+               BorderMode border = BORDER_MODE_REPLICATE, cv::Size tile = cv::Size());
@@ -0,0 +1,249 @@
+//超大图像的分块(overlap-save)频率域滤波
+#include "tiled_frequency_filter.h"
+#include <iostream>
+#include <cmath>
+#include <cfloat>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+//---------------- 行读写 ----------------
+
+bool MatRowSource::read_row(int y, uchar* dst) {
+    if (img_.type() != CV_8UC1 || y < 0 || y >= img_.rows) return false;
+    const uchar* src = img_.ptr<uchar>(y);
+    copy(src, src + img_.cols, dst);
+    return true;
+}
+
+bool MatRowSink::write_row(int y, const uchar* src, int cols) {
+    if (img_.type() != CV_8UC1 || y < 0 || y >= img_.rows || cols != img_.cols) return false;
+    copy(src, src + cols, img_.ptr<uchar>(y));
+    return true;
+}
+
+RawFileRowSource::RawFileRowSource(const string& path, Size size)
+    : file_(path.c_str(), ios::binary), size_(size) {
+    if (!file_.is_open()) cerr << "错误: 无法打开文件 " << path << endl;
+}
+
+bool RawFileRowSource::read_row(int y, uchar* dst) {
+    if (y < 0 || y >= size_.height) return false;
+    file_.seekg((streamoff)y * size_.width);
+    file_.read(reinterpret_cast<char*>(dst), size_.width);
+    return (bool)file_;
+}
+
+RawFileRowSink::RawFileRowSink(const string& path, Size size)
+    : file_(path.c_str(), ios::binary | ios::trunc), size_(size) {
+    if (!file_.is_open()) cerr << "错误: 无法创建文件 " << path << endl;
+}
+
+bool RawFileRowSink::write_row(int y, const uchar* src, int cols) {
+    if (y < 0 || y >= size_.height || cols != size_.width) return false;
+    file_.seekp((streamoff)y * size_.width);
+    file_.write(reinterpret_cast<const char*>(src), cols);
+    return (bool)file_;
+}
+
+//---------------- 分块滤波 ----------------
+
+static inline int wrap_index(int x, int n) {
+    x %= n;
+    return x < 0 ? x + n : x;
+}
+
+//分块网格上的频率下标 (未移位)
+static inline int tile_frequency(int i, int n) {
+    return (i < (n + 1) / 2) ? i : i - n;
+}
+
+template<typename T>
+TiledFrequencyFilter_<T>::TiledFrequencyFilter_(Size image_size, const TransferFunction& h,
+                                                int tile_size, double tolerance)
+    : image_size_(image_size),
+      padded_rows_(getOptimalDFTSize(image_size.height)),
+      padded_cols_(getOptimalDFTSize(image_size.width)),
+      h_(h),
+      tile_(getOptimalDFTSize(max(tile_size, 16))),
+      halo_(0), truncation_error_(0), has_range_(false), min_val_(0), max_val_(0),
+      plan_(tile_, tile_) {
+    for (int k = 0; k < 256; ++k) {
+        lut_[k] = h_.is_homomorphic() ? static_cast<T>(log1p((double)k)) : static_cast<T>(k);
+    }
+    design_kernel(tolerance);
+}
+
+//在N x N的分块网格上设计截断的卷积核，用双精度计算
+template<typename T>
+void TiledFrequencyFilter_<T>::design_kernel(double tolerance) {
+    int n = tile_;
+    RealFFTPlan2D kernel(n, n);
+    int spec_cols = kernel.spectrum_cols();
+
+    //分块频率k (每N个像素k个周期) 对应整幅补零图像上的频率 k * P / N
+    double row_scale = (double)padded_rows_ / n;
+    double col_scale = (double)padded_cols_ / n;
+    for (int i = 0; i < n; ++i) {
+        complex<double>* p = kernel.spectrum_row(i);
+        double u = tile_frequency(i, n) * row_scale;
+        for (int j = 0; j < spec_cols; ++j) p[j] = complex<double>(h_(u, j * col_scale), 0);
+    }
+    kernel.inverse();
+
+    //按切比雪夫距离 max(|x|,|y|) 统计|h|，找到满足容差的最小半径K
+    vector<double> ring(n / 2 + 1, 0.0);
+    double total = 0;
+    for (int y = 0; y < n; ++y) {
+        const double* row = kernel.real_row(y);
+        int dy = abs(tile_frequency(y, n));
+        for (int x = 0; x < n; ++x) {
+            int d = max(dy, abs(tile_frequency(x, n)));
+            ring[d] += fabs(row[x]);
+            total += fabs(row[x]);
+        }
+    }
+    int max_halo = n / 4; //保证每块至少一半是有效输出
+    double tail = total;
+    int k = 0;
+    for (; k <= max_halo; ++k) {
+        tail -= ring[k];
+        if (tail <= tolerance * total) break;
+    }
+    if (k > max_halo) {
+        k = max_halo;
+        cerr << "警告: 卷积核在 " << n << "x" << n << " 的分块内衰减不到容差 " << tolerance
+             << "，实际截断误差 " << tail / total << "，可以增大分块尺寸" << endl;
+    }
+    halo_ = k;
+    truncation_error_ = total > 0 ? max(tail, 0.0) / total : 0.0;
+
+    //截断到 max(|x|,|y|) <= K，正变换得到每块使用的模板；卷积核中心对称，频谱为实数
+    for (int y = 0; y < n; ++y) {
+        double* row = kernel.real_row(y);
+        int dy = abs(tile_frequency(y, n));
+        for (int x = 0; x < n; ++x) {
+            if (max(dy, abs(tile_frequency(x, n))) > halo_) row[x] = 0;
+        }
+    }
+    kernel.forward();
+    mask_.resize((size_t)n * spec_cols);
+    for (int i = 0; i < n; ++i) {
+        const complex<double>* p = kernel.spectrum_row(i);
+        for (int j = 0; j < spec_cols; ++j) mask_[(size_t)i * spec_cols + j] = static_cast<T>(p[j].real());
+    }
+}
+
+template<typename T>
+void TiledFrequencyFilter_<T>::set_output_range(double min_val, double max_val) {
+    has_range_ = true;
+    min_val_ = min_val;
+    max_val_ = max_val;
+}
+
+//读入第 first_row 行起的N行 (每行补零到padded_cols_)，行号按补零后的高度周期延拓
+template<typename T>
+bool TiledFrequencyFilter_<T>::read_band(ImageRowSource& src, int first_row, vector<uchar>& band) {
+    for (int t = 0; t < tile_; ++t) {
+        uchar* dst = &band[(size_t)t * padded_cols_];
+        int y = wrap_index(first_row + t, padded_rows_);
+        if (y < image_size_.height) {
+            if (!src.read_row(y, dst)) {
+                cerr << "错误: 读取第 " << y << " 行失败" << endl;
+                return false;
+            }
+            fill(dst + image_size_.width, dst + padded_cols_, 0);
+        } else {
+            fill(dst, dst + padded_cols_, 0);
+        }
+    }
+    return true;
+}
+
+template<typename T>
+void TiledFrequencyFilter_<T>::filter_tile(const vector<uchar>& band, int x0) {
+    int n = tile_;
+    int left = x0 - halo_;
+    bool inside = left >= 0 && left + n <= padded_cols_;
+    const bool homomorphic = h_.is_homomorphic();
+
+    auto fill_row = [&](int t, T* dst) {
+        const uchar* src = &band[(size_t)t * padded_cols_];
+        if (inside) {
+            for (int c = 0; c < n; ++c) dst[c] = lut_[src[left + c]];
+        } else {
+            for (int c = 0; c < n; ++c) dst[c] = lut_[src[wrap_index(left + c, padded_cols_)]];
+        }
+    };
+    auto row_done = [&](int, T* x) {
+        for (int c = 0; c < n; ++c) {
+            T v = homomorphic ? static_cast<T>(expm1((double)x[c])) : x[c];
+            x[c] = fabs(v);
+        }
+    };
+    plan_.filter(mask_.data(), fill_row, row_done);
+}
+
+template<typename T>
+bool TiledFrequencyFilter_<T>::process(ImageRowSource& src, ImageRowSink& dst) {
+    if (src.size() != image_size_) {
+        cerr << "错误: 输入图像尺寸必须为 " << image_size_.width << "x" << image_size_.height << endl;
+        return false;
+    }
+    int valid = tile_ - 2 * halo_;
+    vector<uchar> band((size_t)tile_ * padded_cols_);
+
+    //第一遍：统计补零后整幅结果的最小、最大值 (与FrequencyFilter_的归一化范围一致)
+    double min_val = min_val_, max_val = max_val_;
+    if (!has_range_) {
+        min_val = numeric_limits<double>::max();
+        max_val = 0;
+        for (int y0 = 0; y0 < padded_rows_; y0 += valid) {
+            if (!read_band(src, y0 - halo_, band)) return false;
+            int rows = min(valid, padded_rows_ - y0);
+            for (int x0 = 0; x0 < padded_cols_; x0 += valid) {
+                filter_tile(band, x0);
+                int cols = min(valid, padded_cols_ - x0);
+                for (int t = 0; t < rows; ++t) {
+                    const T* x = plan_.real_row(halo_ + t) + halo_;
+                    for (int c = 0; c < cols; ++c) {
+                        min_val = min(min_val, (double)x[c]);
+                        max_val = max(max_val, (double)x[c]);
+                    }
+                }
+            }
+        }
+    }
+    double scale = (max_val - min_val > DBL_EPSILON) ? 255.0 / (max_val - min_val) : 0.0;
+    double shift = -min_val * scale;
+
+    //第二遍：滤波、归一化，只写出原始尺寸的部分
+    int width = image_size_.width;
+    vector<uchar> out((size_t)valid * width);
+    for (int y0 = 0; y0 < image_size_.height; y0 += valid) {
+        if (!read_band(src, y0 - halo_, band)) return false;
+        int rows = min(valid, image_size_.height - y0);
+        for (int x0 = 0; x0 < width; x0 += valid) {
+            filter_tile(band, x0);
+            int cols = min(valid, width - x0);
+            for (int t = 0; t < rows; ++t) {
+                const T* x = plan_.real_row(halo_ + t) + halo_;
+                uchar* o = &out[(size_t)t * width + x0];
+                for (int c = 0; c < cols; ++c) o[c] = saturate_cast<uchar>(x[c] * scale + shift);
+            }
+        }
+        for (int t = 0; t < rows; ++t) {
+            if (!dst.write_row(y0 + t, &out[(size_t)t * width], width)) {
+                cerr << "错误: 写入第 " << y0 + t << " 行失败" << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//显式实例化float和double两种精度
+template class TiledFrequencyFilter_<float>;
+template class TiledFrequencyFilter_<double>;
@@ -0,0 +1,113 @@
+// tiled_frequency_filter.h
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include "fft_plan.h"
+#include "frequency_filter.h"
+
+//按行读取超大8位灰度图像的接口，可以随机访问任意一行
+class ImageRowSource {
+public:
+    virtual ~ImageRowSource() {}
+    virtual cv::Size size() const = 0;
+    //读取第y行的size().width个像素
+    virtual bool read_row(int y, uchar* dst) = 0;
+};
+
+//按行写出结果的接口
+class ImageRowSink {
+public:
+    virtual ~ImageRowSink() {}
+    virtual bool write_row(int y, const uchar* src, int cols) = 0;
+};
+
+//内存中的CV_8UC1图像；也可以用Mat(rows, cols, CV_8UC1, ptr)包装一块内存映射的文件
+class MatRowSource : public ImageRowSource {
+public:
+    explicit MatRowSource(const cv::Mat& img) : img_(img) {}
+    cv::Size size() const { return img_.size(); }
+    bool read_row(int y, uchar* dst);
+private:
+    cv::Mat img_;
+};
+
+class MatRowSink : public ImageRowSink {
+public:
+    explicit MatRowSink(cv::Mat& img) : img_(img) {}
+    bool write_row(int y, const uchar* src, int cols);
+private:
+    cv::Mat& img_;
+};
+
+//无文件头的8位原始灰度文件 (按行存放 rows*cols 字节)，按需读写，不整幅载入内存
+class RawFileRowSource : public ImageRowSource {
+public:
+    RawFileRowSource(const std::string& path, cv::Size size);
+    bool is_open() const { return file_.is_open(); }
+    cv::Size size() const { return size_; }
+    bool read_row(int y, uchar* dst);
+private:
+    std::ifstream file_;
+    cv::Size size_;
+};
+
+class RawFileRowSink : public ImageRowSink {
+public:
+    RawFileRowSink(const std::string& path, cv::Size size);
+    bool is_open() const { return file_.is_open(); }
+    bool write_row(int y, const uchar* src, int cols);
+private:
+    std::ofstream file_;
+    cv::Size size_;
+};
+
+//分块(overlap-save)频率域滤波：处理内存放不下的超大图像，结果与FrequencyFilter_整幅滤波一致
+//  1. 把整幅图像(补零到getOptimalDFTSize)上的H(u,v)换算到分块的频率网格上，逆变换得到空间卷积核，
+//     按容差截断到半径K(卷积核|h|在 max(|x|,|y|) > K 处的总和不超过 tolerance * sum|h|)
+//  2. 每块FFT尺寸为N，读入时四周各多读K个像素；滤波后只保留中间 (N-2K) x (N-2K) 的部分
+//  3. 读块时按补零后尺寸周期延拓，与整幅FFT的循环卷积边界完全一致
+//  4. 整幅结果要用全图的最小、最大值归一化，因此第一遍只统计最值，第二遍再滤波并写出
+//     (已知输出范围时可用set_output_range跳过第一遍)
+//内存只与 N 和图像宽度有关：一条 N 行的输入带、一条 N-2K 行的输出带和一个 N x N 的FFT计划
+//误差：未归一化的滤波结果与整幅滤波相差不超过约 truncation_error() * sum|h| * 255；
+//高斯、巴特沃斯滤波器归一化后的8位结果最多相差1个灰度级；理想滤波器的卷积核衰减很慢，误差较大
+template<typename T>
+class TiledFrequencyFilter_ {
+public:
+    TiledFrequencyFilter_(cv::Size image_size, const TransferFunction& h,
+                          int tile_size = 512, double tolerance = 1e-4);
+
+    int tile_size() const { return tile_; }
+    int halo() const { return halo_; }
+    //实际的截断误差 (卷积核被截掉部分的L1范数占比)
+    double truncation_error() const { return truncation_error_; }
+
+    //直接指定归一化用的最小、最大值，process只做一遍
+    void set_output_range(double min_val, double max_val);
+
+    bool process(ImageRowSource& src, ImageRowSink& dst);
+
+private:
+    void design_kernel(double tolerance);
+    bool read_band(ImageRowSource& src, int first_row, std::vector<uchar>& band);
+    //对输入带中以 (x0-K) 为左边界的一块做滤波，结果在plan_的实数缓冲区中
+    void filter_tile(const std::vector<uchar>& band, int x0);
+
+    cv::Size image_size_;
+    int padded_rows_;        //整幅滤波时补零后的尺寸
+    int padded_cols_;
+    TransferFunction h_;
+    int tile_;               //分块FFT尺寸N
+    int halo_;               //K
+    double truncation_error_;
+    bool has_range_;
+    double min_val_, max_val_;
+    RealFFTPlan2D_<T> plan_;
+    std::vector<T> mask_;    //截断后卷积核的频谱 (实数)，rows x (N/2+1)
+    T lut_[256];             //像素到滤波输入的映射 (同态滤波为ln(1+f))
+};
+
+typedef TiledFrequencyFilter_<double> TiledFrequencyFilter;
+typedef TiledFrequencyFilter_<float> TiledFrequencyFilterf;